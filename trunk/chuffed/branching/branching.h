@@ -25,6 +25,8 @@ enum VarBranch {
 	VAR_REDUCED_COST,        // largest reduced cost from MIP
 	VAR_PSEUDO_COST,         // largest pseudo cost from MIP
 	VAR_ACTIVITY,            // largest vsids activity
+	VAR_VMTF,                // most recently in a conflict
+	VAR_LRB,                 // largest learning rate
 	VAR_RANDOM               // random
 };
 
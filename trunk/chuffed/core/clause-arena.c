@@ -0,0 +1,88 @@
+#include <cstdio>
+#include <cstdlib>
+#include <chuffed/core/clause-arena.h>
+
+void ClauseArena::reserve(size_t n) {
+	assert(!mem && !chunks);
+	if (n < (1<<20)) n = 1<<20;
+	if (n > max_cap) n = max_cap;
+	mem = (char*) malloc(n);
+	if (!mem) { perror("malloc()"); exit(1); }
+	cap = n;
+	used = 0;
+}
+
+// The main region is full (or not there yet); the first allocation gets one.
+void* ClauseArena::overflow(size_t n) {
+	if (!mem && !chunks) {
+		reserve(n);
+		used = n;
+		return mem;
+	}
+	if (chunks == 0 || chunk_cap[chunks-1] - chunk_used < n) {
+		// Grow geometrically, so a big database lives in a few large chunks
+		size_t ccap = total;
+		if (ccap > max_chunk) ccap = max_chunk;
+		if (ccap < n) ccap = n;
+		if (chunks == max_chunks || ccap > max_chunk) {
+			fprintf(stderr, "Clause arena full\n");
+			exit(1);
+		}
+		chunk[chunks] = (char*) malloc(ccap);
+		if (!chunk[chunks]) { perror("malloc()"); exit(1); }
+		chunk_cap[chunks++] = ccap;
+		chunk_used = 0;
+	}
+	void *p = chunk[chunks-1] + chunk_used;
+	chunk_used += n;
+	return p;
+}
+
+ClauseArena::Ref ClauseArena::overflowRef(const char *p) const {
+	int k = chunks - 1;
+	while (p < chunk[k] || p >= chunk[k] + chunk_cap[k]) k--;
+	return overflow_bit + ((Ref) k << off_bits) + (Ref) ((p - chunk[k]) >> 3);
+}
+
+Clause* ClauseArena::copy(const Clause *c) {
+	size_t n = bytes(c->size(), c->learnt);
+	Clause *d = (Clause*) raw(n);
+	memcpy(d, c, n);
+	d->in_arena = 1;
+	return d;
+}
+
+Clause* ClauseArena::reloc(Clause *c) {
+	assert(c->in_arena && !c->reloced && c->size() >= 2);
+	Clause *d = copy(c);
+	c->reloced = 1;
+	memcpy((char*) c->data, &d, sizeof(d));
+	return d;
+}
+
+// Hands the memory over to to, which must be empty.
+void ClauseArena::moveTo(ClauseArena& to) {
+	assert(!to.mem && !to.chunks);
+	to.mem = mem;
+	to.cap = cap;
+	to.used = used;
+	for (int i = 0; i < chunks; i++) {
+		to.chunk[i] = chunk[i];
+		to.chunk_cap[i] = chunk_cap[i];
+	}
+	to.chunks = chunks;
+	to.chunk_used = chunk_used;
+	to.total = total;
+	to.wasted = wasted;
+	mem = NULL;
+	chunks = 0;
+	cap = used = chunk_used = total = wasted = 0;
+}
+
+void ClauseArena::clear() {
+	::free(mem);
+	for (int i = 0; i < chunks; i++) ::free(chunk[i]);
+	mem = NULL;
+	chunks = 0;
+	cap = used = chunk_used = total = wasted = 0;
+}
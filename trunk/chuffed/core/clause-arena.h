@@ -0,0 +1,106 @@
+#ifndef clause_arena_h
+#define clause_arena_h
+
+#include <cstring>
+#include <new>
+#include <chuffed/support/vec.h>
+#include <chuffed/core/sat-types.h>
+
+//=================================================================================================
+// ClauseArena -- region allocator for the clauses kept in the SAT database:
+//
+// Clauses are carved out of one large region one after another, so clauses
+// made together (and so usually watched together) are close in memory, and
+// the clause database does not fragment the heap.  A clause is referred to
+// by a Ref, its offset in 8 byte units, which is what the watches store.
+// The region cannot move while there are Clause pointers around, so once it
+// is full clauses go in overflow chunks, whose Refs have the top bit set and
+// are slower to follow.
+//
+// free() only counts the space as wasted; SAT::relocAll() copies the live
+// clauses into a fresh arena, with room to grow, once enough of it is or
+// it has overflowed.  Every clause the database watches is in the arena,
+// as are learnt clauses which might be (they may stay as reasons in the
+// rtrail).  Temporary reasons are still malloc'd, and have in_arena unset.
+
+class ClauseArena {
+public:
+	// A Ref fits the 30 bits a WatchElem has for it
+	typedef unsigned int Ref;
+
+private:
+	static const Ref overflow_bit = 1u << 29;
+	static const int off_bits = 24;        // of a Ref into an overflow chunk
+	static const int max_chunks = 32;
+	static const size_t max_chunk = (size_t) 8 << off_bits;
+	static const size_t max_cap = (size_t) 8 * overflow_bit;
+
+	char *mem;                             // the main region
+	size_t cap;
+	size_t used;
+	char *chunk[max_chunks];               // overflow chunks
+	size_t chunk_cap[max_chunks];
+	int chunks;
+	size_t chunk_used;                     // bytes used in the last chunk
+	size_t total;                          // bytes handed out, live or not
+	size_t wasted;                         // bytes of freed clauses
+
+	void* overflow(size_t n);
+	Ref overflowRef(const char *p) const;
+
+public:
+	ClauseArena() : mem(NULL), cap(0), used(0), chunks(0), chunk_used(0), total(0), wasted(0) {}
+	~ClauseArena() { clear(); }
+
+	static size_t bytes(int sz, bool learnt) {
+		return (sizeof(Clause) + sz * sizeof(Lit) + (learnt ? 2 : 0) * sizeof(int) + 7) & ~(size_t) 7;
+	}
+
+	template<class V>
+	Clause* alloc(const V& ps, bool learnt) {
+		Clause *c = new (raw(bytes(ps.size(), learnt))) Clause(ps, learnt);
+		c->in_arena = 1;
+		return c;
+	}
+	void* raw(size_t n) {
+		total += n;
+		if (cap - used < n) return overflow(n);
+		void *p = mem + used;
+		used += n;
+		return p;
+	}
+	// Copies a clause made elsewhere into the arena.
+	Clause* copy(const Clause *c);
+
+	Ref ref(const Clause *c) const {
+		const char *p = (const char*) c;
+		if (p >= mem && p < mem + cap) return (Ref) ((p - mem) >> 3);
+		return overflowRef(p);
+	}
+	Clause* deref(Ref r) const {
+		if (!(r & overflow_bit)) return (Clause*) (mem + ((size_t) r << 3));
+		r -= overflow_bit;
+		return (Clause*) (chunk[r >> off_bits] + ((size_t) (r & ((1 << off_bits) - 1)) << 3));
+	}
+
+	void free(Clause *c) { assert(c->in_arena); wasted += bytes(c->size(), c->learnt); }
+	// c lost lits (simplification); they stay allocated until relocation.
+	void shrunk(Clause *c, int old_sz) {
+		wasted += bytes(old_sz, c->learnt) - bytes(c->size(), c->learnt);
+	}
+
+	// Copies a live clause into this arena, leaving a forwarding pointer in
+	// the original.
+	Clause* reloc(Clause *c);
+	static Clause* forward(Clause *c) { Clause *n; memcpy(&n, (char*) c->data, sizeof(n)); return n; }
+
+	size_t size() const { return total; }
+	size_t wastedBytes() const { return wasted; }
+	bool overflowed() const { return chunks > 0; }
+	// Sets up the main region, before anything is allocated.
+	void reserve(size_t n);
+	void moveTo(ClauseArena& to);
+	void clear();
+};
+
+#endif
@@ -33,32 +33,89 @@ inline void SAT::learntLenBumpActivity(int l) {
 	confl_rate += 1 / learnt_len_el;
 }
 
+// VMTF and LRB keep their own scores in activity, in [0,1] for LRB,
+// so only VSIDS decays it.  IntVar activity always decays.
 inline void SAT::varDecayActivity() {
-	if ((var_inc *= 1.05) > 1e100) {
+	if (so.sat_heuristic == 0 && (var_inc *= 1.05) > 1e100) {
 		for (int i = 0; i < nVars(); i++) activity[i] *= 1e-100;
-		for (int i = 0; i < engine.vars.size(); i++) engine.vars[i]->activity *= 1e-100;
 		var_inc *= 1e-100;
 	}
+	if ((ivar_inc *= 1.05) > 1e100) {
+		for (int i = 0; i < engine.vars.size(); i++) engine.vars[i]->activity *= 1e-100;
+		ivar_inc *= 1e-100;
+	}
 }
 
 inline void SAT::varBumpActivity(Lit p) {
 	int v = var(p);
 	if (so.vsids) {
-		activity[v] += var_inc;
-		if (order_heap.inHeap(v)) order_heap.decrease(v);
+		if (so.sat_heuristic == 0) {
+			activity[v] += var_inc;
+			if (order_heap.inHeap(v)) order_heap.decrease(v);
+		}
 		if (so.sat_polarity == 1) polarity[v] = sign(p)^1;
 		if (so.sat_polarity == 2) polarity[v] = sign(p);
 	}
+	if (so.sat_heuristic == 1) vmtf_bumped.push(v);
+	if (so.sat_heuristic == 2) lrb_participated[v]++;
 	if (c_info[v].cons_type == 1) {
 		int var_id = c_info[v].cons_id;
 		if (!ivseen[var_id]) {
-			engine.vars[var_id]->activity += var_inc;
+			IntVar* x = engine.vars[var_id];
+			x->activity += ivar_inc;
+			x->lr_score += lr_alpha * (1.0 / (engine.conflicts - x->last_conflict) - x->lr_score);
+			x->last_conflict = engine.conflicts;
 			ivseen[var_id] = true;
 			ivseen_toclear.push(var_id);
 		}
 	}
 }
 
+// The number of distinct decision levels among the lits, FD decision levels
+// included, as they are in the trail
+template <class T>
+int SAT::computeLBD(T& ps) {
+	if (++lbd_stamp < 0) {
+		for (int i = 0; i < lbd_seen.size(); i++) lbd_seen[i] = 0;
+		lbd_stamp = 1;
+	}
+	int lbd = 0;
+	for (int i = 0; i < ps.size(); i++) {
+		int l = level[var(ps[i])];
+		if (l >= lbd_seen.size()) lbd_seen.growTo(l+1, 0);
+		if (lbd_seen[l] != lbd_stamp) {
+			lbd_seen[l] = lbd_stamp;
+			lbd++;
+		}
+	}
+	return lbd;
+}
+
+inline unsigned int SAT::abstractLevel(int x) const {
+	return 1u << (level[x] & 31);
+}
+
+inline int SAT::lbdTier(int lbd) const {
+	if (lbd <= so.lbd_core) return TIER_CORE;
+	if (lbd <= so.lbd_tier2) return TIER_2;
+	return TIER_LOCAL;
+}
+
+// c is a learnt clause used in analysis: mark it, and promote it if its LBD
+// has gone down.
+inline void SAT::updateLBD(Clause& c) {
+	c.used = 1;
+	if (c.tier == TIER_CORE) return;
+	int lbd = computeLBD(c);
+	if (lbd >= c.lbd()) return;
+	c.lbd() = lbd;
+	int tier = lbdTier(lbd);
+	if (tier > (int) c.tier) {
+		c.tier = tier;
+		tier_promotions[tier]++;
+	}
+}
+
 inline void SAT::claDecayActivity() {
 	if ((cla_inc *= 1.001) > 1e20) {
 		for (int i = 0; i < learnts.size(); i++) learnts[i]->activity() *= 1e-20;
@@ -75,7 +132,10 @@ Clause* SAT::_getExpl(Lit p) {
 #ifdef LOGGING
   logging::active_item = engine.propagators[r.d.d2]->prop_origin;
 #endif
-	return engine.propagators[r.d.d2]->explain(p, r.d.d1);
+	explaining = true;
+	Clause* c = engine.propagators[r.d.d2]->explain(p, r.d.d1);
+	explaining = false;
+	return c;
 }
 
 Clause* SAT::getConfl(Reason& r, Lit p) {
@@ -95,8 +155,8 @@ Clause* SAT::getConfl(Reason& r, Lit p) {
 		default:
 			Clause& c = *short_expl;
 #ifdef LOGGING
-      assert(r.d.type = 2);
-      c.sz = r.d.type; c[1] = toLit(r.d.d1); c.origin = r.d.d2;
+      assert(r.d.type == 2);
+      c.sz = 2; c[1] = toLit(r.d.d1); c.ident = r.d.d2;
 #else
 			c.sz = r.d.type; c[1] = toLit(r.d.d1); c[2] = toLit(r.d.d2);
 #endif
@@ -113,11 +173,27 @@ void SAT::analyze() {
 	checkConflict();
 	varDecayActivity();
 	claDecayActivity();
+	if (lr_alpha > 0.06) lr_alpha -= 1e-6;
 	getLearntClause();
+	if (so.sat_heuristic == 1) vmtfBump();
 	explainUnlearnable();
+	if (so.learnt_minimise) minimiseLearnt();
+	if (so.strengthen_bounds) strengthenBounds();
 	clearSeen();
+	int lbd = computeLBD(out_learnt);
+	if (so.restart_type == 1) updateRestartAvgs(lbd);
 
 	int btlevel = findBackTrackLevel();
+	// A long backjump undoes a lot of FD propagation which will mostly be
+	// redone, so just undo the conflict level.  The asserted lit then sits
+	// above its own level, btlevel, so it is kept in chrono_lits, and implied
+	// again by btToLevel if a backtrack in between undoes it.
+	bool chrono = so.chrono_backtrack && so.learn && out_learnt.size() >= 2 &&
+		decisionLevel()-1-btlevel > so.chrono_backtrack;
+	if (chrono) {
+		btlevel = decisionLevel()-1;
+		chrono_backtracks++;
+	}
 	back_jumps += decisionLevel()-1-btlevel;
 //	fprintf(stderr, "btlevel = %d\n", btlevel);
 	btToLevel(btlevel);
@@ -127,8 +203,13 @@ void SAT::analyze() {
 		std::sort((Lit*) out_learnt + 2, (Lit*) out_learnt + out_learnt.size(), lit_sort);
 	}
 
-	Clause *c = Clause_new(out_learnt, true);
+	// Learnt clauses go in the arena, as they may be watched
+	Clause *c = so.learn && out_learnt.size() >= 2 ? ca.alloc(out_learnt, true) : Clause_new(out_learnt, true);
 	c->activity() = cla_inc;
+	c->lbd() = lbd;
+	c->tier = lbdTier(lbd);
+	c->used = 1;
+	if (so.learn && c->size() > 2) tier_learnts[c->tier]++;
 #ifdef LOGGING
   logging::resolve(c);
 #endif
@@ -139,18 +220,28 @@ void SAT::analyze() {
 		slave.shareClause(*c);
 	}
 
-	if (so.learn && c->size() >= 2) addClause(*c, so.one_watch);
-#ifdef LOGGING
-  if(!so.learn) rtrail.last().push(c);
-#else
-	if (!so.learn || c->size() <= 2) rtrail.last().push(c);
-#endif
+	// After a chronological backtrack the other lits can stay false while the
+	// asserted lit is undone, so the clause must see that lit become false too.
+	bool one_watch = so.one_watch && !chrono;
 
 #ifndef LOGGING
+	if (so.learn && c->size() >= 2) addClause(*c, one_watch);
+	if (!so.learn || c->size() <= 2) rtrail.last().push(c);
+
 	enqueue(out_learnt[0], c->size() == 2 ? Reason(out_learnt[1]) : c);
 #else
-  enqueue(out_learnt[0], c);
+  // A learnt binary clause which fits in the watches keeps its ident there,
+  // so c itself is just a temporary.
+  bool inline_bin = so.learn && c->size() == 2 && c->ident < BIN_IDENT_LIMIT;
+  Reason r(c);
+  if (inline_bin) r = Reason(out_learnt[1], c->ident);
+	if (so.learn && c->size() >= 2) addClause(*c, one_watch);
+	if (!so.learn || inline_bin) rtrail.last().push(c);
+
+	enqueue(out_learnt[0], r);
 #endif
+	if (chrono) chrono_lits.last().push(out_learnt[0]);
+	reimplyMissed();
 
 	if (PRINT_ANALYSIS) printClause(*c);
 
@@ -166,7 +257,10 @@ void SAT::analyze() {
 	if (so.ldsb && !ldsb.processImpl(c)) engine.async_fail = true;
 
 	if (learnts.size() >= so.nof_learnts ||
-		learnts_literals >= so.learnts_mlimit/4) reduceDB();
+		learnts_literals >= so.learnts_mlimit/4) reduceDB(true);
+	else if (so.reduce_base && engine.conflicts >= next_reduce_db) reduceDB();
+
+	if (so.rephase_base && engine.conflicts >= next_rephase) rephase();
 }
 
 
@@ -197,7 +291,10 @@ void SAT::getLearntClause() {
 			printClause(c);
 		}
 
-		if (c.learnt) c.activity() += cla_inc;
+		if (c.learnt) {
+			c.activity() += cla_inc;
+			updateLBD(c);
+		}
 
 		for (int j = (p == lit_Undef) ? 0 : 1; j < c.size(); j++) {
 			Lit q = c[j];
@@ -240,12 +337,11 @@ FindNextExpl:
 }
 
 int SAT::findConflictLevel() {
-	int tp = -1;
+	int clevel = 0;
 	for (int i = 0; i < confl->size(); i++) {
-		int l = trailpos[var((*confl)[i])];
-		if (l > tp) tp = l;
+		int l = level[var((*confl)[i])];
+		if (l > clevel) clevel = l;
 	}
-	int clevel = engine.tpToLevel(tp);
 
 	if (so.sym_static && clevel == 0) {
 		btToLevel(0);
@@ -299,6 +395,139 @@ void SAT::explainUnlearnable() {
 	pushback_time += wallClockTime();
 }
 
+// Drops the lits of out_learnt which are implied by the others through their
+// reasons (MiniSat's recursive minimisation).  Lazy reasons are not followed:
+// these lits are below the conflict level, and explaining them would mean
+// backtracking the FD state past it.
+void SAT::minimiseLearnt() {
+	unsigned int abstract_levels = 0;
+	for (int i = 1; i < out_learnt.size(); i++) abstract_levels |= abstractLevel(var(out_learnt[i]));
+
+	out_learnt.copyTo(analyze_toclear);
+	int i, j;
+	for (i = j = 1; i < out_learnt.size(); i++) {
+		Lit p = out_learnt[i];
+#ifdef LOGGING
+		int top = analyze_toclear.size();
+#endif
+		if (!litRedundant(p, abstract_levels)) {
+			out_learnt[j++] = p;
+			continue;
+		}
+#ifdef LOGGING
+		// The reasons p was removed by are antecedents of the learnt clause
+		if (so.logging) {
+			logging::antecedents.push(logging::infer(~p, getExpl(~p)));
+			for (int k = top; k < analyze_toclear.size(); k++) {
+				Lit q = analyze_toclear[k];
+				logging::antecedents.push(logging::infer(~q, getExpl(~q)));
+			}
+		}
+#endif
+	}
+	max_literals += out_learnt.size();
+	out_learnt.shrink(i - j);
+	tot_literals += out_learnt.size();
+
+	for (i = 0; i < analyze_toclear.size(); i++) seen[var(analyze_toclear[i])] = 0;
+}
+
+// Without a trace, root lits are not marked seen when LOGGING is compiled in,
+// and the reasons of those cleaned up at the top level may have been freed.
+// They are false for good, so they need no reason.
+inline bool SAT::rootFalse(int x) const {
+#ifdef LOGGING
+	return !so.logging && isRootLevel(x);
+#else
+	return false;
+#endif
+}
+
+// Whether the false lit p is implied by lits which are seen, following only
+// reasons which can be had without backtracking.  The lits it goes through
+// are left seen and in analyze_toclear.
+bool SAT::litRedundant(Lit p, unsigned int abstract_levels) {
+	analyze_stack.clear();
+	analyze_stack.push(p);
+	int top = analyze_toclear.size();
+	while (analyze_stack.size() > 0) {
+		Lit q = analyze_stack.last();
+		analyze_stack.pop();
+		if (rootFalse(var(q))) continue;
+		Clause* c = reason[var(q)].isLazy() ? NULL : getExpl(~q);
+		bool ok = (c != NULL);
+		for (int k = 1; ok && k < c->size(); k++) {
+			Lit l = (*c)[k];
+			int x = var(l);
+			if (seen[x] || rootFalse(x)) continue;
+			if (reason[x].isLazy() || !(abstractLevel(x) & abstract_levels)) ok = false;
+			else {
+				seen[x] = 1;
+				analyze_stack.push(l);
+				analyze_toclear.push(l);
+			}
+		}
+		if (!ok) {
+			for (int k = top; k < analyze_toclear.size(); k++) seen[var(analyze_toclear[k])] = 0;
+			analyze_toclear.shrink(analyze_toclear.size() - top);
+			return false;
+		}
+	}
+	return true;
+}
+
+// Of the bound lits of out_learnt on one IntVar and in one direction, only
+// the weakest is needed, as the others imply it: [x <= 3] \/ [x <= 5] is
+// just [x <= 5].  The asserting lit is never dropped.
+void SAT::strengthenBounds() {
+	int removed = 0;
+	for (int i = 0; i < out_learnt.size(); i++) {
+		Lit p = out_learnt[i];
+		ChannelInfo& ci = c_info[var(p)];
+		if (ci.cons_type != 1 || ci.val_type != 1) continue;
+		int b = 2*ci.cons_id + sign(p);
+		if (bound_lit[b] == 0) {
+			bound_lit[b] = i+1;
+			bound_lit_toclear.push(b);
+			continue;
+		}
+		int k = bound_lit[b]-1;
+		Lit q = out_learnt[k];
+		// [x <= v] gets weaker as v grows, [x >= v+1] as v shrinks
+		bool weaker = sign(p) ? ci.val < c_info[var(q)].val : ci.val > c_info[var(q)].val;
+		int drop = i;
+		if (weaker) {
+			bound_lit[b] = i+1;
+			if (k == 0) continue;
+			drop = k;
+			q = p;
+		}
+		Lit d = out_learnt[drop];
+#ifdef LOGGING
+		// d implies q by the semantics of the lits
+		if (so.logging) {
+			Clause* c = Reason_new(2);
+			c->origin = 0;
+			(*c)[1] = q;
+			logging::antecedents.push(logging::infer(~d, c));
+		}
+#endif
+		seen[var(d)] = 0;
+		out_learnt[drop] = lit_Undef;
+		removed++;
+	}
+	for (int i = 0; i < bound_lit_toclear.size(); i++) bound_lit[bound_lit_toclear[i]] = 0;
+	bound_lit_toclear.clear();
+
+	if (removed == 0) return;
+	int i, j;
+	for (i = j = 0; i < out_learnt.size(); i++) {
+		if (out_learnt[i] != lit_Undef) out_learnt[j++] = out_learnt[i];
+	}
+	out_learnt.shrink(i - j);
+	bound_lits_removed += removed;
+}
+
 void SAT::clearSeen() {
 	for (int i = 0; i < ivseen_toclear.size(); i++) ivseen[ivseen_toclear[i]] = false;
 	ivseen_toclear.clear();
@@ -320,7 +549,7 @@ int SAT::findBackTrackLevel() {
 	out_learnt[max_i] = out_learnt[1];
 	out_learnt[1] = p;
 
-	return engine.tpToLevel(trailpos[var(p)]);
+	return level[var(p)];
 }
 
 
@@ -28,9 +28,13 @@ Engine::Engine() :
 	, nodes(1)
 	, propagations(0)
 	, solutions(0)
+	, restarts(0)
 	, next_simp_db(0)
 {
 	p_queue.growTo(num_queues);
+	p_qhead.growTo(num_queues, 0);
+	queue_props.growTo(num_queues, 0);
+	queue_idle.growTo(num_queues, 0);
 	for (int i = 0; i < 64; i++) bit[i] = ((long long) 1 << i);
 	branching = new BranchGroup();
 	mip = new MIP();
@@ -116,16 +120,28 @@ bool Engine::propagate() {
 
 	last_prop = NULL;
 
+	// Lower priority queues are run to fix point before any propagator in a
+	// higher one, each queue in FIFO or LIFO order
 	for (int i = 0; i < num_queues; i++) {
-		if (p_queue[i].size()) {
-			Propagator *p = p_queue[i].last(); p_queue[i].pop();
+		vec<Propagator*>& q = p_queue[i];
+		if (p_qhead[i] < q.size()) {
+			Propagator *p;
+			if (so.prop_fifo) {
+				p = q[p_qhead[i]++];
+				if (p_qhead[i] == q.size()) { q.clear(); p_qhead[i] = 0; }
+			} else {
+				p = q.last(); q.pop();
+			}
 			propagations++;
+			queue_props[i]++;
+			int sat_trail = sat.trail.last().size();
 #ifdef LOGGING
       logging::active_item = p->prop_origin;
 #endif
 			bool ok = p->propagate();
 			p->clearPropState();
 			if (!ok) return false;
+			if (v_queue.size() == 0 && sat.trail.last().size() == sat_trail) queue_idle[i]++;
 			goto WakeUp;
 		}
 	}
@@ -139,8 +155,9 @@ void Engine::clearPropState() {
 	v_queue.clear();
 
 	for (int i = 0; i < num_queues; i++) {
-		for (int j = 0; j < p_queue[i].size(); j++) p_queue[i][j]->clearPropState();
+		for (int j = p_qhead[i]; j < p_queue[i].size(); j++) p_queue[i][j]->clearPropState();
 		p_queue[i].clear();
+		p_qhead[i] = 0;
 	}
 }
 
@@ -280,11 +297,13 @@ RESULT Engine::search() {
 
 		} else {
 
-			if (conflictC >= nof_conflicts) {
+			if (so.restart_type == 1 ? sat.restartDue() : conflictC >= nof_conflicts) {
 				starts++;
-				nof_conflicts += getRestartLimit((starts+1)/2);
-				sat.btToLevel(0);
+				restarts++;
+				if (so.restart_type == 1) sat.restart_conflicts = 0;
+				else nof_conflicts += getRestartLimit((starts+1)/2);
 				sat.confl = NULL;
+				sat.btToLevel(0);
 				if (so.lazy && so.toggle_vsids && (starts % 2 == 0)) toggleVSIDS();
 				continue;
 			}
@@ -318,6 +337,14 @@ RESULT Engine::search() {
 
 			if (!di) {
 				solutions++;
+				if (so.target_phase || so.sol_phase || so.rephase_base) {
+					sat.saveSolutionPhases();
+					if (so.sol_phase) {
+						for (int i = 0; i < vars.size(); i++) {
+							if (vars[i]->isFixed()) vars[i]->sol_val = vars[i]->getVal();
+						}
+					}
+				}
 				if (so.print_sol) {
 					problem->print();
 					printf("----------\n");
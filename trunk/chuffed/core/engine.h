@@ -46,6 +46,7 @@ public:
 	// Intermediate propagation state
 	vec<IntVar*> v_queue;                      // List of changed vars
 	vec<vec<Propagator*> > p_queue;            // Queue of propagators to run
+	vec<int> p_qhead;                          // Next propagator in each queue with prop_fifo
 	Propagator *last_prop;                     // Last propagator run, set for idempotent propagators
 	bool async_fail;                           // Asynchronous failure
 
@@ -59,7 +60,9 @@ public:
 	// Statistics
 	double start_time, init_time, opt_time, search_time;
 	double base_memory;
-	long long int conflicts, nodes, propagations, solutions, next_simp_db;
+	long long int conflicts, nodes, propagations, solutions, restarts, next_simp_db;
+	vec<long long int> queue_props;            // Propagations run from each queue
+	vec<long long int> queue_idle;             // Of those, ones which changed nothing
 
 private:
 
@@ -99,10 +102,6 @@ public:
 
 	int decisionLevel() const { return trail_lim.size(); }
 	int trailPos() const { return trail.size(); }
-	int tpToLevel(int tp) const {
-		for (int i = trail_lim.size(); i--; ) if (tp >= trail_lim[i]) return i+1;
-		return 0;
-	}
 
 };
 
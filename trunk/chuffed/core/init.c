@@ -28,7 +28,7 @@ void Engine::init() {
 
 	for (int i = 0; i < vars.size(); i++) {
 		IntVar *v = vars[i];
-		if (v->pinfo.size() == 0) v->in_queue = true;
+		if (v->degree() == 0) v->in_queue = true;
 		else v->pushInQueue();
 	}
 
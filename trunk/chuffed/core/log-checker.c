@@ -0,0 +1,218 @@
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <sched.h>
+#include <chuffed/core/log-format.h>
+#include <chuffed/core/log-checker.h>
+
+namespace logging {
+
+void LogChecker::start(int buffer_mb) {
+  ring.init((size_t) buffer_mb << 20);
+  done = false;
+  if(pthread_create(&thread, NULL, run, this)) {
+    perror("pthread_create()");
+    exit(1);
+  }
+  running = true;
+}
+
+void LogChecker::send(void) {
+  if(!out.empty())
+    ring.put((const char*) &out[0], out.size() * sizeof(unsigned int));
+  out.clear();
+}
+
+bool LogChecker::finish(void) {
+  if(!running)
+    return !failed;
+  send();
+  __atomic_store_n(&done, true, __ATOMIC_RELEASE);
+  pthread_join(thread, NULL);
+  running = false;
+  return !failed;
+}
+
+void* LogChecker::run(void* checker) {
+  ((LogChecker*) checker)->drain();
+  return NULL;
+}
+
+// Words arrive whole, since the search thread only ever puts whole words;
+// records may still be split across blocks, so the unparsed tail is kept
+// in pending.
+void LogChecker::drain(void) {
+  std::vector<unsigned int> pending;
+  unsigned int start = 0;
+  int spins = 0;
+  while(true) {
+    const char* buf;
+    int len = ring.peek(buf);
+    if(!len) {
+      if(__atomic_load_n(&done, __ATOMIC_ACQUIRE) && ring.empty())
+        break;
+      if(spins++ < 64) {
+        sched_yield();
+      } else {
+        struct timespec ts = { 0, 50000 };
+        nanosleep(&ts, NULL);
+      }
+      continue;
+    }
+    spins = 0;
+    assert(len % sizeof(unsigned int) == 0);
+    const unsigned int* w = (const unsigned int*) buf;
+    pending.insert(pending.end(), w, w + len / sizeof(unsigned int));
+    ring.consume(len);
+
+    int n;
+    while(!failed && (n = parse(&pending[0] + start, pending.size() - start)))
+      start += n;
+    if(failed)
+      break;
+    if(start > pending.size() / 2) {
+      pending.erase(pending.begin(), pending.begin() + start);
+      start = 0;
+    }
+  }
+  if(!failed && start < pending.size())
+    fail(0, "incomplete record");
+  // Let the search thread run on, whatever happened.
+  while(!__atomic_load_n(&done, __ATOMIC_ACQUIRE) || !ring.empty()) {
+    const char* buf;
+    int len = ring.peek(buf);
+    if(len)
+      ring.consume(len);
+    else
+      sched_yield();
+  }
+}
+
+// Check the record at the start of w; returns its length, or 0 if it is
+// not all there yet.
+int LogChecker::parse(const unsigned int* w, int len) {
+  if(len < 2)
+    return 0;
+  unsigned int tag = w[0];
+  unsigned int ident = w[1];
+  if(tag == LOG_DELETE) {
+    if(ident >= clauses.size() || !live[ident]) {
+      fail(ident, "deleting a clause which does not exist");
+      return 2;
+    }
+    live[ident] = false;
+    std::vector<unsigned int>().swap(clauses[ident]);
+    return 2;
+  }
+
+  int lits = 2, ants;
+  while(lits < len && w[lits])
+    lits++;
+  if(lits == len)
+    return 0;
+  ants = lits + 1;
+  if(tag == LOG_RESOLVE) {
+    while(ants < len && w[ants])
+      ants++;
+    if(ants == len)
+      return 0;
+  }
+
+  if(ident < clauses.size() && live[ident]) {
+    fail(ident, "clause ident reused");
+    return ants + 1;
+  }
+  if(tag == LOG_RESOLVE) {
+    if(!check(ident, w + 2, lits - 2, w + lits + 1, ants - lits - 1)) {
+      if(!failed)
+        fail(ident, "not implied by its antecedents");
+      return ants + 1;
+    }
+    checked++;
+    if(lits == 2)
+      empty_checked = true;
+  } else if(tag != LOG_ADD) {
+    fail(ident, "unknown record");
+    return len;
+  }
+
+  if(ident >= clauses.size()) {
+    clauses.resize(ident+1);
+    live.resize(ident+1, false);
+  }
+  clauses[ident].assign(w + 2, w + lits);
+  live[ident] = true;
+  return tag == LOG_RESOLVE ? ants + 1 : lits + 1;
+}
+
+void LogChecker::fail(unsigned int ident, const char* reason) {
+  failed = true;
+  fail_ident = ident;
+  fail_reason = reason;
+  fprintf(stderr, "%% proof check failed at step %u: %s\n", ident, reason);
+}
+
+void LogChecker::assign(unsigned int lit) {
+  unsigned int v = lit >> 1;
+  if(v >= vals.size())
+    vals.resize(v+1, 0);
+  vals[v] = (lit & 1) ? -1 : 1;
+  trail.push_back(v);
+}
+
+// Assume the negation of the clause, then propagate the antecedents until
+// one of them is falsified.
+bool LogChecker::check(unsigned int ident, const unsigned int* lits, int nlits,
+                       const unsigned int* ants, int nants) {
+  for(int ii = 0; ii < nants; ii++) {
+    if(ants[ii] >= clauses.size() || !live[ants[ii]]) {
+      fail(ident, "antecedent does not exist");
+      return false;
+    }
+  }
+
+  bool conflict = false;
+  for(int ii = 0; ii < nlits && !conflict; ii++) {
+    signed char v = value(lits[ii]);
+    if(v > 0)
+      conflict = true;     // Tautology
+    else if(!v)
+      assign(lits[ii] ^ 1);
+  }
+
+  bool changed = true;
+  while(changed && !conflict) {
+    changed = false;
+    for(int ii = 0; ii < nants && !conflict; ii++) {
+      const std::vector<unsigned int>& cl(clauses[ants[ii]]);
+      unsigned int unit = 0;
+      int open = 0;
+      for(unsigned int jj = 0; jj < cl.size(); jj++) {
+        signed char v = value(cl[jj]);
+        if(v > 0) {
+          open = -1;
+          break;
+        }
+        if(!v) {
+          unit = cl[jj];
+          if(++open > 1)
+            break;
+        }
+      }
+      if(!open) {
+        conflict = true;
+      } else if(open == 1) {
+        assign(unit);
+        changed = true;
+      }
+    }
+  }
+
+  for(unsigned int ii = 0; ii < trail.size(); ii++)
+    vals[trail[ii]] = 0;
+  trail.clear();
+  return conflict;
+}
+
+};
@@ -0,0 +1,79 @@
+#ifndef CHUFFED_LOG_CHECKER_H
+#define CHUFFED_LOG_CHECKER_H
+
+#include <cstddef>
+#include <vector>
+#include <pthread.h>
+#include <chuffed/core/log-writer.h>
+
+namespace logging {
+
+// Checks the proof trace while it is being written (-log_check).  The
+// search thread sends every record to a checker thread through a ByteRing,
+// as a sequence of words:
+//
+//   LOG_ADD ident lits.. 0             inferred clause (trusted)
+//   LOG_RESOLVE ident lits.. 0 ants.. 0
+//   LOG_DELETE ident
+//
+// with literals coded as in log-format.h.  Each resolved clause must follow
+// from its antecedents by unit propagation (reverse unit propagation, but
+// restricted to the antecedents); the first one which does not is reported.
+// Inferred clauses are the constraints' explanations, and are checked
+// against the model by fdres-check, not here.
+class LogChecker {
+public:
+  LogChecker() : failed(false), fail_ident(0), fail_reason(NULL), checked(0),
+                 empty_checked(false), running(false), done(false) { }
+
+  void start(int buffer_mb);
+  // Finish checking what was sent; returns false if a step failed.
+  bool finish(void);
+  bool isRunning(void) const { return running; }
+
+  // Search thread side.
+  void put(unsigned int word) {
+    out.push_back(word);
+    if(out.size() >= out_block)
+      send();
+  }
+  void send(void);
+
+  bool failed;
+  unsigned int fail_ident;
+  const char* fail_reason;
+  long long checked;                     // Resolution steps verified
+  bool empty_checked;                    // Was the empty clause derived?
+
+private:
+  static const unsigned int out_block = 1<<14;
+
+  void drain(void);
+  static void* run(void* checker);
+  int parse(const unsigned int* w, int len);
+  void fail(unsigned int ident, const char* reason);
+  bool check(unsigned int ident, const unsigned int* lits, int nlits,
+             const unsigned int* ants, int nants);
+
+  // Literal values, indexed by literal code: 1 = true, -1 = false.
+  signed char value(unsigned int lit) const {
+    return (lit >> 1) < vals.size() ? vals[lit >> 1] * ((lit & 1) ? -1 : 1) : 0;
+  }
+  void assign(unsigned int lit);
+
+  bool running;
+  bool done;
+  ByteRing ring;
+  pthread_t thread;
+  std::vector<unsigned int> out;         // Words not yet sent
+
+  // Checker thread state
+  std::vector<std::vector<unsigned int> > clauses;   // ident -> lits
+  std::vector<bool> live;
+  std::vector<signed char> vals;         // var+1 -> value of positive literal
+  std::vector<unsigned int> trail;
+};
+
+};
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef CHUFFED_LOG_FORMAT_H
+#define CHUFFED_LOG_FORMAT_H
+
+#include <cstdio>
+#include <zlib.h>
+
+// Binary encoding of the proof trace (-log_binary=true).
+//
+// The file starts with log_magic, followed by a sequence of records, each
+// introduced by a one-byte tag.  All numbers are unsigned LEB128 varints.
+//
+//   'h' hint                       constraint hint (0 = none), text "c c<hint>"
+//   'a' id_delta lits.. 0          inferred clause, text "<id> lits.. 0 0"
+//   'r' id_delta lits.. 0 ants.. 0 resolved clause, text "<id> lits.. 0 ants.. 0"
+//   'd' del_delta                  deletion, text "d <id>"
+//
+// The file may additionally be gzip-compressed (-log_compress).
+//
+// id_delta is the clause ident minus the ident of the previous clause record,
+// so is almost always 1.  A literal is coded as 2*(var+1) + neg, so it is never
+// 0.  Antecedents are coded as (ident - antecedent), and deletions as
+// (previous clause ident - deleted ident) + 1, so neither is ever 0 either.
+
+namespace logging {
+
+static const char log_magic[4] = { 'D', 'R', 'B', '1' };
+
+enum LogTag {
+  LOG_HINT    = 'h',
+  LOG_ADD     = 'a',
+  LOG_RESOLVE = 'r',
+  LOG_DELETE  = 'd'
+};
+
+// Write x into buf, returns the number of bytes used (at most 5).
+static inline int encode_varint(char* buf, unsigned int x) {
+  int n = 0;
+  while(x >= 0x80) {
+    buf[n++] = (char) ((x & 0x7f) | 0x80);
+    x >>= 7;
+  }
+  buf[n++] = (char) x;
+  return n;
+}
+
+// Returns false on end of file.  in may be gzipped or plain.
+static inline bool read_varint(gzFile in, unsigned int& x) {
+  x = 0;
+  for(int shift = 0; shift < 35; shift += 7) {
+    int c = gzgetc(in);
+    if(c == EOF)
+      return false;
+    x |= ((unsigned int) (c & 0x7f)) << shift;
+    if(!(c & 0x80))
+      return true;
+  }
+  return false;
+}
+
+// Read a varint from memory, advancing p.
+static inline unsigned int decode_varint(const char*& p) {
+  unsigned int x = 0;
+  for(int shift = 0; ; shift += 7) {
+    unsigned char c = *p++;
+    x |= ((unsigned int) (c & 0x7f)) << shift;
+    if(!(c & 0x80))
+      return x;
+  }
+}
+
+static inline unsigned int encode_lit(int var, bool neg) {
+  return 2*(var+1) + neg;
+}
+
+static inline int decode_lit(unsigned int code) {
+  return (code & 1) ? -((int) (code >> 1)) : (int) (code >> 1);
+}
+
+};
+
+#endif
@@ -0,0 +1,239 @@
+#include <cassert>
+#include <climits>
+#include <cstdarg>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <sched.h>
+#include <chuffed/support/misc.h>
+#include <chuffed/core/log-writer.h>
+
+namespace logging {
+
+static inline unsigned long long load_acquire(unsigned long long* p) {
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void store_release(unsigned long long* p, unsigned long long x) {
+  __atomic_store_n(p, x, __ATOMIC_RELEASE);
+}
+
+static void backoff(int& spins) {
+  if(spins++ < 64) {
+    sched_yield();
+  } else {
+    struct timespec ts = { 0, 50000 };
+    nanosleep(&ts, NULL);
+  }
+}
+
+ByteRing::~ByteRing() {
+  free(data);
+}
+
+void ByteRing::init(size_t min_cap) {
+  cap = 4096;
+  while(cap < min_cap && cap <= UINT_MAX / 2)
+    cap <<= 1;
+  data = (char*) malloc(cap);
+  if(!data) { perror("malloc()"); exit(1); }
+  head = tail = 0;
+}
+
+void ByteRing::put(const char* buf, int len) {
+  while(len > 0) {
+    unsigned long long t = tail;
+    int spins = 0;
+    unsigned int space;
+    while((space = cap - (unsigned int) (t - load_acquire(&head))) == 0) {
+      if(!spins)
+        stalls++;
+      backoff(spins);
+    }
+    unsigned int off = t & (cap-1);
+    unsigned int n = len;
+    if(n > space) n = space;
+    if(n > cap - off) n = cap - off;
+    memcpy(data + off, buf, n);
+    store_release(&tail, t + n);
+    buf += n;
+    len -= n;
+  }
+}
+
+int ByteRing::peek(const char*& buf) {
+  unsigned long long h = head;
+  unsigned int avail = (unsigned int) (load_acquire(&tail) - h);
+  unsigned int off = h & (cap-1);
+  if(avail > cap - off)
+    avail = cap - off;
+  buf = data + off;
+  return avail;
+}
+
+void ByteRing::consume(int len) {
+  store_release(&head, head + len);
+}
+
+bool ByteRing::empty(void) {
+  return load_acquire(&tail) == load_acquire(&head);
+}
+
+//-----
+
+bool LogWriter::open(const char* path, int compress_level, bool _async, int buffer_mb) {
+  if(compress_level) {
+    char mode[4] = { 'w', 'b', (char) ('0' + compress_level), 0 };
+    if(!(gz = gzopen(path, mode)))
+      return false;
+    gzbuffer(gz, 1<<17);
+  } else {
+    if(!(file = fopen(path, "w")))
+      return false;
+  }
+  async = _async;
+  done = false;
+  if(!async)
+    return true;
+  ring.init((size_t) buffer_mb << 20);
+  pthread_mutex_init(&barrier_lock, NULL);
+  if(pthread_create(&thread, NULL, run, this)) {
+    perror("pthread_create()");
+    async = false;
+  }
+  return true;
+}
+
+void LogWriter::output(const char* buf, int len) {
+  if(gz)
+    gzwrite(gz, buf, len);
+  else
+    fwrite(buf, 1, len, file);
+}
+
+void LogWriter::write(const char* buf, int len) {
+  dirty = true;
+  if(!async)
+    output(buf, len);
+  else
+    ring.put(buf, len);
+}
+
+void LogWriter::printf(const char* fmt, ...) {
+  char buf[256];
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  if(n < (int) sizeof(buf)) {
+    write(buf, n);
+    return;
+  }
+  char* big = (char*) malloc(n+1);
+  va_start(ap, fmt);
+  vsnprintf(big, n+1, fmt, ap);
+  va_end(ap);
+  write(big, n);
+  free(big);
+}
+
+// Nothing is done if there is nothing new, as each gzflush costs a sync
+// block in the stream.
+unsigned long long LogWriter::flush(void) {
+  if(!dirty)
+    return flush_req;
+  dirty = false;
+  if(async) {
+    store_release(&flush_req, ring.tail);
+    return flush_req;
+  }
+  if(gz)
+    gzflush(gz, Z_SYNC_FLUSH);
+  else if(file)
+    fflush(file);
+  return 0;
+}
+
+unsigned long long LogWriter::syncedTo(void) const {
+  return __atomic_load_n(&synced, __ATOMIC_ACQUIRE);
+}
+
+void LogWriter::waitFor(const LogWriter& dep, unsigned long long mark) {
+  if(!async) {
+    int spins = 0;
+    while(dep.syncedTo() < mark)
+      backoff(spins);
+    return;
+  }
+  Barrier b = { ring.tail, mark, &dep };
+  pthread_mutex_lock(&barrier_lock);
+  barriers.push_back(b);
+  pthread_mutex_unlock(&barrier_lock);
+}
+
+// Writer thread: carries out a flush asked for by the search thread, once
+// everything up to it has been output.
+void LogWriter::sync(void) {
+  unsigned long long req = load_acquire(&flush_req);
+  if(req <= synced || ring.head < req)
+    return;
+  if(gz)
+    gzflush(gz, Z_SYNC_FLUSH);
+  else
+    fflush(file);
+  store_release(&synced, ring.head);
+}
+
+// Writer thread: how many of the len readable bytes may be output now,
+// given the barriers still waiting on other writers.
+int LogWriter::held(int len) {
+  pthread_mutex_lock(&barrier_lock);
+  while(!barriers.empty() && barriers.front().dep->syncedTo() >= barriers.front().mark)
+    barriers.pop_front();
+  if(!barriers.empty() && ring.head + len > barriers.front().offset)
+    len = (int) (barriers.front().offset - ring.head);
+  pthread_mutex_unlock(&barrier_lock);
+  return len;
+}
+
+void LogWriter::drain(void) {
+  int spins = 0;
+  while(true) {
+    const char* buf;
+    int len = held(ring.peek(buf));
+    if(len) {
+      output(buf, len);
+      ring.consume(len);
+      sync();
+      spins = 0;
+      continue;
+    }
+    sync();
+    if(__atomic_load_n(&done, __ATOMIC_ACQUIRE) && ring.empty())
+      break;
+    backoff(spins);
+  }
+}
+
+void* LogWriter::run(void* writer) {
+  ((LogWriter*) writer)->drain();
+  return NULL;
+}
+
+void LogWriter::close(void) {
+  if(!isOpen())
+    return;
+  if(async) {
+    __atomic_store_n(&done, true, __ATOMIC_RELEASE);
+    pthread_join(thread, NULL);
+    pthread_mutex_destroy(&barrier_lock);
+  }
+  if(gz)
+    gzclose(gz);
+  else
+    fclose(file);
+  file = NULL;
+  gz = NULL;
+}
+
+};
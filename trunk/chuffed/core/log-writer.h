@@ -0,0 +1,93 @@
+#ifndef CHUFFED_LOG_WRITER_H
+#define CHUFFED_LOG_WRITER_H
+
+#include <cstdio>
+#include <deque>
+#include <pthread.h>
+#include <zlib.h>
+
+namespace logging {
+
+// Bounded single-producer/single-consumer byte queue.  head and tail are
+// free-running counters; only the producer advances tail, and only the
+// consumer advances head, so no locks are needed.
+class ByteRing {
+public:
+  ByteRing() : data(NULL), cap(0), head(0), tail(0), stalls(0) { }
+  ~ByteRing();
+
+  void init(size_t min_cap);
+
+  // Producer side: blocks while the ring is full.
+  void put(const char* buf, int len);
+
+  // Consumer side: the contiguous readable region, and releasing it.
+  int peek(const char*& buf);
+  void consume(int len);
+
+  bool empty(void);
+
+  char* data;
+  unsigned int cap;                      // a power of two
+  unsigned long long head;               // bytes consumed
+  unsigned long long tail;               // bytes produced
+  long long stalls;                      // times the producer had to wait
+};
+
+// Sends blocks of trace data to a file, either directly, or (when async)
+// through a ByteRing drained by a dedicated writer thread, so the search
+// thread does not pay stdio and kernel write latency.  If compress_level is
+// non-zero the file is a gzip stream, deflated by whichever thread does the
+// writing.
+class LogWriter {
+public:
+  LogWriter() : file(NULL), gz(NULL), async(false), done(false), dirty(false),
+                flush_req(0), synced(0) { }
+
+  bool open(const char* path, int compress_level, bool async, int buffer_mb);
+  void write(const char* buf, int len);
+  void printf(const char* fmt, ...);
+
+  // Pushes out what has been written so far.  An async writer only asks its
+  // thread to do it; the result is the offset syncedTo() has to reach.
+  unsigned long long flush(void);
+  unsigned long long syncedTo(void) const;
+
+  // Nothing written from here on reaches the file before dep has synced up
+  // to mark.  A synchronous writer simply waits for it.
+  void waitFor(const LogWriter& dep, unsigned long long mark);
+
+  void close(void);
+
+  bool isOpen(void) const { return file != NULL || gz != NULL; }
+  long long stalls(void) const { return ring.stalls; }
+
+private:
+  void output(const char* buf, int len);
+  void sync(void);
+  int held(int len);
+  void drain(void);
+  static void* run(void* writer);
+
+  struct Barrier {
+    unsigned long long offset;           // in this writer's stream
+    unsigned long long mark;             // in dep's stream
+    const LogWriter* dep;
+  };
+
+  FILE* file;
+  gzFile gz;
+  bool async;
+  bool done;
+  bool dirty;                            // written to since the last flush
+  unsigned long long flush_req;          // async: offset to flush up to
+  unsigned long long synced;             // async: offset flushed so far
+  ByteRing ring;
+  pthread_t thread;
+  std::deque<Barrier> barriers;
+  pthread_mutex_t barrier_lock;
+};
+
+};
+
+#endif
@@ -1,9 +1,17 @@
 #include <cstdlib>
 #include <cstdio>
+#include <unistd.h>
 #include <vector>
+#include <algorithm>
+#include <map>
+#include <tr1/unordered_map>
+#include <chuffed/support/misc.h>
 #include <chuffed/support/vec.h>
 #include <chuffed/core/sat-types.h>
 #include <chuffed/core/logging.h>
+#include <chuffed/core/log-format.h>
+#include <chuffed/core/log-writer.h>
+#include <chuffed/core/log-checker.h>
 #include <chuffed/core/sat.h>
 #include <chuffed/primitives/primitives.h>
 
@@ -17,6 +25,95 @@ static unsigned int active_hint = 0;
 vec<int> antecedents;
 vec<int> temporaries;
 
+// Ids of the SAT vars in the trace.  A recycled lazy var gets a fresh one,
+// as its old literal may still be in the trace; vars made before logging
+// started keep their own.
+static std::vector<int> trace_var;
+static int trace_vars = 0;
+
+static inline int tvar(int vi) {
+  return vi < (int) trace_var.size() ? trace_var[vi] : vi;
+}
+
+// Explanation cache (-log_expl_cache): temporary explanations are
+// hash-consed on their sorted literals, so an explanation that is
+// regenerated (typically by the same lazy propagator after backtracking or
+// a restart) reuses the ident it was logged under.  refs counts the
+// temporary clauses currently holding the ident; entries with no refs stay
+// alive in the trace until a sweep evicts them.
+struct expl_entry {
+  expl_entry() : ident(0), refs(0), used(false) { }
+  unsigned int ident;
+  int refs;
+  bool used;      // Acquired since the last sweep?
+};
+
+struct expl_hash {
+  size_t operator()(const std::vector<int>& lits) const {
+    size_t h = 2166136261u;
+    for(unsigned int ii = 0; ii < lits.size(); ii++)
+      h = (h ^ lits[ii]) * 16777619u;
+    return h;
+  }
+};
+
+typedef std::tr1::unordered_map<std::vector<int>, expl_entry, expl_hash> expl_table;
+static expl_table expl_cache;
+static std::tr1::unordered_map<unsigned int, expl_table::value_type*> expl_idents;
+static unsigned int expl_sweep_at = 0;
+static long long expl_hits = 0;
+
+static void expl_sweep(void) {
+  for(expl_table::iterator it = expl_cache.begin(); it != expl_cache.end(); ) {
+    expl_entry& e(it->second);
+    if(e.refs || e.used) {
+      e.used = false;
+      ++it;
+    } else {
+      temporaries.push(e.ident);
+      expl_idents.erase(e.ident);
+      expl_cache.erase(it++);
+    }
+  }
+  expl_sweep_at = expl_cache.size() + std::max(so.log_expl_cache/2, 1);
+}
+
+// Returns the ident cl is already logged under, or 0 after recording that
+// it is about to be logged as ident.
+static unsigned int expl_acquire(Clause* cl, unsigned int ident) {
+  std::vector<int> key(cl->size());
+  for(int ii = 0; ii < cl->size(); ii++)
+    key[ii] = encode_lit(tvar(var((*cl)[ii])), sign((*cl)[ii]));
+  std::sort(key.begin(), key.end());
+
+  std::pair<expl_table::iterator, bool> r(expl_cache.insert(expl_table::value_type(key, expl_entry())));
+  expl_entry& e(r.first->second);
+  e.refs++;
+  e.used = true;
+  if(!r.second) {
+    expl_hits++;
+    return e.ident;
+  }
+  e.ident = ident;
+  expl_idents[ident] = &*r.first;
+  if(expl_cache.size() >= expl_sweep_at)
+    expl_sweep();
+  return 0;
+}
+
+// A temporary clause no longer holds ident; cached idents are kept for
+// reuse, anything else is deleted at the next resolution step.
+static void expl_release(unsigned int ident) {
+  if(so.log_expl_cache) {
+    std::tr1::unordered_map<unsigned int, expl_table::value_type*>::iterator it(expl_idents.find(ident));
+    if(it != expl_idents.end()) {
+      it->second->second.refs--;
+      return;
+    }
+  }
+  temporaries.push(ident);
+}
+
 struct ivar_ident {
   ivar_ident() : is_bound(false), sym("") { }
   ivar_ident(std::string _sym) : is_bound(true), sym(_sym) { }
@@ -41,6 +138,17 @@ static bool ivar_is_bound(IntVar* v) {
   return ivar_is_bound(v->var_id);
 }
 
+// Literal semantics are written to log.lit as the literals are created
+// (new_vars), so the file is usable at any point of the run.  Literals of
+// integer variables which are not named yet wait in pending_lits, indexed
+// by variable, until bind_ivar.  Unnamed variables are fixed, so their
+// literals are written as constants once they are fixed at the root
+// (unit); any still waiting at the end are written by finalize.
+static std::vector<std::vector<int> > pending_lits;
+static std::vector<bool> lit_pending;
+
+static void write_fixed_lit(int vi);
+
 struct binding {
   binding(const std::string& sym, Lit l)
     : ident(sym), kind(B_Lit), lit(toInt(l)) { }
@@ -59,8 +167,267 @@ struct binding {
 static bool has_model = false;
 static std::vector<binding> bindings;
 
-FILE* log_file = stderr;
-FILE* lit_file = stderr;
+static LogWriter log_writer;
+static LogWriter lit_writer;
+
+// Trace records are formatted into log_buf and handed to log_writer in large
+// blocks; going through fprintf for every number dominated run time.  With
+// -log_async=true, the writers copy each block into a ring buffer and a
+// separate thread per file does the file I/O (and compression).
+static const int log_buf_size = 1<<16;
+static char log_buf[log_buf_size];
+static int log_pos = 0;
+static unsigned int last_ident = 0;
+static bool log_binary = false;   // Encoding used by the put_ functions
+
+// With -log_trim=true, records are encoded (always in binary) into
+// trim_store instead of the file, and at the end only those the empty
+// clause depends on are written; see trim_emit.
+static bool trimming = false;
+static std::vector<char> trim_store;
+static std::vector<size_t> trim_offset;        // ident -> position in trim_store
+static unsigned int empty_ident = 0;
+
+static void trim_emit(void);
+
+// With -log_check=true, every record is also sent to checker, which
+// verifies the resolution steps on another thread as they are made.
+static LogChecker checker;
+static bool checking = false;
+static bool check_failed = false;
+
+// Cost accounting (-log_stats), per origin (FlatZinc constraint item).
+// Steps made by resolution are charged to resolution_cost.  bytes are
+// counted before compression, and in binary when trimming.
+struct origin_cost {
+  origin_cost() : clauses(0), lits(0), bytes(0), time(0) { }
+  long long clauses;
+  long long lits;
+  long long bytes;
+  double time;
+};
+static std::vector<origin_cost> origin_costs;
+static std::vector<std::string> origin_names;
+static origin_cost resolution_cost;
+static long long log_flushed = 0;   // Bytes passed on by log_flush
+static int cost_depth = 0;
+
+static void write_cost_csv(void);
+
+static inline long long log_offset(void);
+
+static origin_cost& cost_of(int origin) {
+  if(origin < 0)
+    return resolution_cost;
+  if(origin >= (int) origin_costs.size())
+    origin_costs.resize(origin+1);
+  return origin_costs[origin];
+}
+
+// Charges the time spent in the outermost logging call to an origin
+// (-1 for resolution).
+struct cost_timer {
+  cost_timer(int _origin) : origin(_origin), outer(false) {
+    if(!so.log_stats)
+      return;
+    outer = !cost_depth++;
+    if(outer)
+      start = wallClockTime();
+  }
+  ~cost_timer(void) {
+    if(!so.log_stats)
+      return;
+    cost_depth--;
+    if(outer)
+      cost_of(origin).time += wallClockTime() - start;
+  }
+  int origin;
+  bool outer;
+  double start;
+};
+
+static inline void note_record(int origin, int lits, long long start) {
+  origin_cost& c(cost_of(origin));
+  c.clauses++;
+  c.lits += lits;
+  c.bytes += log_offset() - start;
+}
+
+static void log_flush(void) {
+  if(log_pos) {
+    // Every literal in the block is described in log.lit by the time the
+    // block reaches the trace file.  When both are async, the trace
+    // writer's thread holds the block back until the lit writer's thread
+    // has flushed that far.
+    unsigned long long lits = lit_writer.flush();
+    log_flushed += log_pos;
+    if(checking)
+      checker.send();
+    if(trimming)
+      trim_store.insert(trim_store.end(), log_buf, log_buf + log_pos);
+    else {
+      log_writer.waitFor(lit_writer, lits);
+      log_writer.write(log_buf, log_pos);
+    }
+    log_pos = 0;
+  }
+}
+
+static inline long long log_offset(void) {
+  return log_flushed + log_pos;
+}
+
+static void finish_check(void) {
+  if(!checking)
+    return;
+  checking = false;
+  if(!checker.finish()) {
+    check_failed = true;
+    return;
+  }
+  fprintf(stderr, "%% proof check: %lld resolution steps verified, %s\n", checker.checked,
+          checker.empty_checked ? "empty clause derived" : "no empty clause");
+}
+
+static void finish_trace(void) {
+  finish_check();
+  if(so.log_stats)
+    write_cost_csv();
+  if(trimming)
+    trim_emit();
+  log_flush();
+  log_writer.close();
+}
+
+bool check_ok(void) {
+  return !check_failed;
+}
+
+static void exit_flush(void) {
+  if(log_writer.isOpen())
+    finish_trace();
+  lit_writer.close();
+  // Leaving through exit() elsewhere; the status can only be changed here
+  if(check_failed) {
+    fflush(NULL);
+    _exit(2);
+  }
+}
+
+inline void log_reserve(int n) {
+  if(log_pos + n > log_buf_size)
+    log_flush();
+}
+
+inline void put_char(char c) {
+  log_reserve(1);
+  log_buf[log_pos++] = c;
+}
+
+inline void put_int(int x) {
+  char tmp[12];
+  int n = 0;
+  unsigned int u = x < 0 ? -((unsigned int) x) : x;
+  do {
+    tmp[n++] = '0' + u%10;
+    u /= 10;
+  } while(u);
+  log_reserve(n+2);
+  if(x < 0)
+    log_buf[log_pos++] = '-';
+  while(n)
+    log_buf[log_pos++] = tmp[--n];
+  log_buf[log_pos++] = ' ';
+}
+
+inline void put_varint(unsigned int x) {
+  log_reserve(5);
+  log_pos += encode_varint(log_buf + log_pos, x);
+}
+
+inline void put_lit_code(unsigned int code) {
+  if(checking)
+    checker.put(code);
+  if(log_binary)
+    put_varint(code);
+  else
+    put_int(decode_lit(code));
+}
+
+inline void put_lit(Lit l) {
+  put_lit_code(encode_lit(tvar(var(l)), !sign(l)));
+}
+
+// Start a clause record; finish it with end_lits, then put_ant for
+// each antecedent, then end_ants.
+inline void begin_clause(unsigned int ident, bool resolved) {
+  if(trimming) {
+    assert(ident == trim_offset.size());
+    trim_offset.push_back(trim_store.size() + log_pos);
+  }
+  if(checking) {
+    checker.put(resolved ? LOG_RESOLVE : LOG_ADD);
+    checker.put(ident);
+  }
+  if(log_binary) {
+    put_char(resolved ? LOG_RESOLVE : LOG_ADD);
+    put_varint(ident - last_ident);
+  } else {
+    put_int(ident);
+  }
+  last_ident = ident;
+}
+
+inline void end_lits(void) {
+  if(checking)
+    checker.put(0);
+  if(log_binary)
+    put_varint(0);
+  else
+    put_int(0);
+}
+
+inline void put_ant(int ant) {
+  if(checking)
+    checker.put(ant);
+  if(log_binary)
+    put_varint(last_ident - ant);
+  else
+    put_int(ant);
+}
+
+// Inferred clauses have no antecedent list in the binary format.
+inline void end_ants(bool resolved = true) {
+  if(checking && resolved)
+    checker.put(0);
+  if(log_binary) {
+    if(resolved)
+      put_varint(0);
+  } else {
+    log_reserve(2);
+    log_buf[log_pos++] = '0';
+    log_buf[log_pos++] = '\n';
+  }
+}
+
+inline void put_delete(unsigned int ident) {
+  if(checking) {
+    checker.put(LOG_DELETE);
+    checker.put(ident);
+  }
+  // Deletions are recomputed when trimming.
+  if(trimming)
+    return;
+  if(log_binary) {
+    put_char(LOG_DELETE);
+    put_varint(last_ident - ident + 1);
+  } else {
+    put_char('d');
+    put_char(' ');
+    put_int(ident);
+    log_buf[log_pos-1] = '\n';
+  }
+}
 
 void save_model(void) {
   if(!so.logging && !so.log_solution)
@@ -98,8 +465,33 @@ void init(void) {
   if(!so.logging)
     return;
 
-  log_file = fopen(so.logfile, "w");
-  lit_file = fopen(so.litfile,"w");
+  // With -log_compress, both files are gzipped and get a .gz suffix.
+  std::string suffix(so.log_compress ? ".gz" : "");
+  std::string logfile(so.logfile + suffix);
+  std::string litfile(so.litfile + suffix);
+  if(!log_writer.open(logfile.c_str(), so.log_compress, so.log_async, so.log_buffer)) {
+    perror(logfile.c_str());
+    exit(1);
+  }
+  if(!lit_writer.open(litfile.c_str(), so.log_compress, so.log_async, so.log_buffer)) {
+    perror(litfile.c_str());
+    exit(1);
+  }
+  log_binary = so.log_binary;
+  if(so.log_binary)
+    log_writer.write(log_magic, sizeof(log_magic));
+  if(so.log_trim) {
+    trimming = true;
+    log_binary = true;
+    trim_offset.push_back(0);
+  }
+  if(so.log_check) {
+    checker.start(so.log_buffer);
+    checking = true;
+  }
+  lit_writer.printf("1 [lit_True >= 1]\n");
+  lit_writer.printf("2 [lit_True < 1]\n");
+  atexit(exit_flush);
 }
 
 void finalize(void) {
@@ -109,41 +501,126 @@ void finalize(void) {
   if(!so.logging)
     return;
 
-  // Output literal semantics   
-  fprintf(lit_file, "1 [lit_True >= 1]\n");
-  fprintf(lit_file, "2 [lit_True < 1]\n");
-  for(int vi = 2; vi < sat.assigns.size(); vi++) {
-    ChannelInfo& ci = sat.c_info[vi];
-	  if (ci.cons_type == 1) {
-      if(!ivar_is_bound(ci.cons_id)) {
-//        fprintf(stderr, "WARNING: variable %d has no name.\n", ci.cons_id);
-        if(toLbool(sat.assigns[vi]) == l_False) {
-          fprintf(lit_file, "%d [lit_True >= 1]\n", vi+1); 
-        } else if(toLbool(sat.assigns[vi]) == l_True) {
-            fprintf(lit_file, "%d [lit_True < 1]\n", vi+1);
-        }
-        continue;
-      }
-      fprintf(lit_file, "%d [%s %s %d]\n", vi+1, ivar_idents[ci.cons_id].sym.c_str(), ci.val_type ? ">" : "=", ci.val);
-      // fprintf(lit_file, "%d [v%d %s %d]\n", vi, vi+1, ci.val_type ? ">=" : "=", ci.val);
+  // Literals of unnamed variables
+  for(unsigned int ii = 0; ii < pending_lits.size(); ii++) {
+    for(unsigned int jj = 0; jj < pending_lits[ii].size(); jj++) {
+//      fprintf(stderr, "WARNING: variable %d has no name.\n", ii);
+      write_fixed_lit(pending_lits[ii][jj]);
     }
   }
-  
-  fclose(log_file);
-  fclose(lit_file);
+
+
+  finish_trace();
+  lit_writer.close();
+  if(so.log_async && so.verbosity >= 2)
+    fprintf(stderr, "%lld proof log writer stalls\n", log_writer.stalls());
+  if(so.log_expl_cache && so.verbosity >= 2)
+    fprintf(stderr, "%lld explanations reused from the cache\n", expl_hits);
 }
 
 inline void set_hint(unsigned int hint) {
   if(hint != active_hint) {
-    if(hint) {
-      fprintf(log_file, "c c%d\n", hint);
+    if(log_binary) {
+      put_char(LOG_HINT);
+      put_varint(hint);
+    } else if(hint) {
+      put_char('c');
+      put_char(' ');
+      put_char('c');
+      put_int(hint);
+      log_buf[log_pos-1] = '\n';
     } else {
-      fprintf(log_file, "c -\n");
+      put_char('c');
+      put_char(' ');
+      put_char('-');
+      put_char('\n');
     }
     active_hint = hint;
   }
 }
 
+// Write out the steps the empty clause depends on (all of them if search
+// stopped without one), renumbered densely from 1.  A backward pass over
+// trim_store marks the needed steps and finds the last use of each; the
+// forward pass writes them in the requested format, deleting each clause
+// straight after the step that last uses it.
+static void trim_emit(void) {
+  log_flush();
+  trimming = false;
+  log_binary = so.log_binary;
+
+  unsigned int n = trim_offset.size();
+  std::vector<bool> needed(n, !empty_ident);
+  std::vector<unsigned int> last_use(n, 0);
+  if(empty_ident)
+    needed[empty_ident] = true;
+  for(unsigned int id = n-1; id > 0; id--) {
+    if(!needed[id])
+      continue;
+    const char* p = &trim_store[trim_offset[id]];
+    if(*p++ != LOG_RESOLVE)
+      continue;
+    decode_varint(p);
+    while(decode_varint(p)) ;
+    unsigned int x;
+    while((x = decode_varint(p))) {
+      needed[id - x] = true;
+      if(!last_use[id - x])
+        last_use[id - x] = id;
+    }
+  }
+
+  std::vector<unsigned int> renum(n, 0);
+  vec<unsigned int> lits;
+  vec<unsigned int> ants;
+  unsigned int ident = 0, hint = 0, kept = 0;
+  last_ident = 0;
+  active_hint = 0;
+  const char* p = trim_store.empty() ? NULL : &trim_store[0];
+  const char* end = p + trim_store.size();
+  while(p < end) {
+    char tag = *p++;
+    if(tag == LOG_HINT) {
+      hint = decode_varint(p);
+      continue;
+    }
+    assert(tag == LOG_ADD || tag == LOG_RESOLVE);
+    ident += decode_varint(p);
+    lits.clear();
+    ants.clear();
+    unsigned int x;
+    while((x = decode_varint(p)))
+      lits.push(x);
+    if(tag == LOG_RESOLVE) {
+      while((x = decode_varint(p)))
+        ants.push(ident - x);
+    }
+    if(!needed[ident])
+      continue;
+
+    renum[ident] = ++kept;
+    set_hint(hint);
+    begin_clause(kept, tag == LOG_RESOLVE);
+    for(int ii = 0; ii < lits.size(); ii++)
+      put_lit_code(lits[ii]);
+    end_lits();
+    for(int ii = 0; ii < ants.size(); ii++)
+      put_ant(renum[ants[ii]]);
+    end_ants(tag == LOG_RESOLVE);
+    for(int ii = 0; ii < ants.size(); ii++) {
+      if(last_use[ants[ii]] == ident) {
+        put_delete(renum[ants[ii]]);
+        last_use[ants[ii]] = 0;
+      }
+    }
+  }
+  if(so.verbosity >= 2)
+    fprintf(stderr, "%d of %d proof steps kept by trimming\n", kept, n-1);
+
+  std::vector<char>().swap(trim_store);
+  std::vector<size_t>().swap(trim_offset);
+}
+
 inline void log_lits(Clause* cl) {
   if(!so.logging)
     return;
@@ -152,13 +629,27 @@ inline void log_lits(Clause* cl) {
     Lit l((*cl)[ii]);
 //    if(sat.flags[var(l)].no_log)
 //      continue;
-    fprintf(log_file, "%s%d ", sign(l) ? "" : "-", var(l)+1);
+    put_lit(l);
   }
 }
 
+// Write cl as an inference of the constraint it came from.
+inline void write_inferred(Clause* cl) {
+  long long start = log_offset();
+  set_hint(cl->origin);
+
+  begin_clause(cl->ident, false);
+  log_lits(cl);
+  end_lits();
+  end_ants(false);
+  if(so.log_stats)
+    note_record(cl->origin, cl->size(), start);
+}
+
 int intro(Clause* cl) {
   if(!so.logging)
     return INT_MAX;
+  cost_timer t(cl->origin);
 
   assert(!cl->temp_expl);
   if(cl->ident) {
@@ -166,17 +657,14 @@ int intro(Clause* cl) {
   }
   cl->ident = ++infer_count;
 
-  set_hint(cl->origin);
-
-  fprintf(log_file, "%d ", cl->ident);
-  log_lits(cl);
-  fprintf(log_file, "0 0\n");
+  write_inferred(cl);
   return cl->ident;
 }
 
 int infer(Lit l, Clause* cl) {
   if(!so.logging)
     return INT_MAX;
+  cost_timer t(cl->origin);
 #ifdef CHECK_LOG
   assert(sat.value(l) != l_Undef);
   for(int ii = 1; ii < cl->size(); ii++) {
@@ -193,9 +681,13 @@ int infer(Lit l, Clause* cl) {
       if((*cl)[0] == l)
         return cl->ident;
       // fprintf(log_file, "d %d\n", cl->ident);
-      temporaries.push(cl->ident);
+      expl_release(cl->ident);
     }
     (*cl)[0] = l;
+    if(so.log_expl_cache) {
+      if((cl->ident = expl_acquire(cl, infer_count+1)))
+        return cl->ident;
+    }
     cl->ident = ++infer_count; 
 #endif
   } else if(cl->ident) {
@@ -210,11 +702,7 @@ int infer(Lit l, Clause* cl) {
     assert((*cl)[0] == l);
 #endif
 
-  set_hint(cl->origin);
-
-  fprintf(log_file, "%d ", cl->ident);
-  log_lits(cl);
-  fprintf(log_file, "0 0\n");
+  write_inferred(cl);
   return cl->ident;
 }
 
@@ -226,14 +714,17 @@ int log_resolve(Clause* cl, vec<int>& antecedents) {
   cl->origin = 0;
   cl->ident = ++infer_count;
 
-  fprintf(log_file, "%d ", cl->ident);
+  long long start = log_offset();
+  begin_clause(cl->ident, true);
   log_lits(cl);
-  fprintf(log_file, "0 ");
+  end_lits();
   for(int ii = 0; ii < antecedents.size(); ii++) {
-    fprintf(log_file, "%d ", antecedents[ii]);
+    put_ant(antecedents[ii]);
   }
-  fprintf(log_file, "0\n");
+  end_ants();
   antecedents.clear();
+  if(so.log_stats)
+    note_record(-1, cl->size(), start);
 
   return cl->ident;
 }
@@ -243,10 +734,11 @@ int resolve(Clause* cl) {
     antecedents.clear();
     return INT_MAX;
   }
+  cost_timer t(-1);
   int ident = log_resolve(cl, antecedents);
 
   for(int ii = 0; ii < temporaries.size(); ii++) {
-    fprintf(log_file, "d %d\n", temporaries[ii]);
+    put_delete(temporaries[ii]);
   }
   temporaries.clear();
 
@@ -259,11 +751,17 @@ void empty(vec<int>& antecedents) {
   if(!so.logging)
     return;
 
-  fprintf(log_file, "%d 0 ", ++infer_count);
+  cost_timer t(-1);
+  long long start = log_offset();
+  empty_ident = ++infer_count;
+  begin_clause(empty_ident, true);
+  end_lits();
   for(int ii = 0; ii < antecedents.size(); ii++) {
-    fprintf(log_file, "%d ", antecedents[ii]);
+    put_ant(antecedents[ii]);
   }
-  fprintf(log_file, "0\n");
+  end_ants();
+  if(so.log_stats)
+    note_record(-1, 0, start);
 }
 
 void del(Clause* cl) {
@@ -277,7 +775,7 @@ void del(Clause* cl) {
     return;
 
   // fprintf(log_file, "d %d\n", cl->ident);
-  temporaries.push(cl->ident);
+  expl_release(cl->ident);
   cl->ident = 0;
 }
 
@@ -300,9 +798,12 @@ inline Clause* unit_clause(Lit l) {
 int unit(Lit l) {
   if(!so.logging)
     return INT_MAX;
+  cost_timer t(-1);
 #ifdef CHECK_LOG
   assert(sat.value(l) == l_True);
 #endif
+  if(var(l) < (int) lit_pending.size())
+    write_fixed_lit(var(l));
 
   Clause* r = sat.getExpl(l);
   if(!r) {
@@ -325,6 +826,7 @@ int unit(Lit l) {
 void push_unit(vec<int>& ants, Lit l) {
   if(!so.logging)
     return;
+  cost_timer t(-1);
 //  if(sat.flags[var(l)].no_log)
 //    return;
 #ifdef CHECK_LOG
@@ -334,6 +836,110 @@ void push_unit(vec<int>& ants, Lit l) {
 };
 
 
+static void write_lit(int vi) {
+  ChannelInfo& ci = sat.c_info[vi];
+  int val = ci.val;
+  // Sparse variables channel the index of the value
+  IntVar* x = engine.vars[ci.cons_id];
+  if(x->getType() == INT_VAR_SL)
+    val = ((IntVarSL*) x)->logValue(ci.val, ci.val_type);
+  lit_writer.printf("%d [%s %s %d]\n", tvar(vi)+1, ivar_idents[ci.cons_id].sym.c_str(), ci.val_type ? ">" : "=", val);
+}
+
+// A literal of an unnamed variable, by its current value.
+static void write_fixed_lit(int vi) {
+  if(!lit_pending[vi])
+    return;
+  if(toLbool(sat.assigns[vi]) == l_False) {
+    lit_writer.printf("%d [lit_True >= 1]\n", tvar(vi)+1); 
+  } else if(toLbool(sat.assigns[vi]) == l_True) {
+    lit_writer.printf("%d [lit_True < 1]\n", tvar(vi)+1);
+  } else {
+    return;
+  }
+  lit_pending[vi] = false;
+}
+
+void name_origin(unsigned int origin, const std::string& name) {
+  if(!so.log_stats)
+    return;
+  if(origin >= origin_names.size())
+    origin_names.resize(origin+1);
+  if(origin_names[origin].empty())
+    origin_names[origin] = name;
+}
+
+static const std::string& origin_name(unsigned int origin) {
+  static const std::string unnamed("(other)");
+  if(origin < origin_names.size() && !origin_names[origin].empty())
+    return origin_names[origin];
+  return unnamed;
+}
+
+struct cost_row {
+  cost_row() : items(0) { }
+  int items;
+  origin_cost c;
+};
+
+static bool cost_row_gt(const std::pair<std::string, cost_row>& a, const std::pair<std::string, cost_row>& b) {
+  return a.second.c.bytes > b.second.c.bytes;
+}
+
+// Cost summary by constraint name, largest first.
+void printStats(void) {
+  if(!so.logging || !so.log_stats)
+    return;
+  std::map<std::string, cost_row> rows;
+  for(unsigned int ii = 0; ii < origin_costs.size(); ii++) {
+    origin_cost& c(origin_costs[ii]);
+    if(!c.clauses && c.time == 0)
+      continue;
+    cost_row& r(rows[origin_name(ii)]);
+    r.items++;
+    r.c.clauses += c.clauses;
+    r.c.lits += c.lits;
+    r.c.bytes += c.bytes;
+    r.c.time += c.time;
+  }
+  rows["(resolution)"].c = resolution_cost;
+  std::vector<std::pair<std::string, cost_row> > sorted(rows.begin(), rows.end());
+  std::sort(sorted.begin(), sorted.end(), cost_row_gt);
+
+  fprintf(stderr, "\nProof logging cost by constraint:\n");
+  fprintf(stderr, "%-28s %8s %10s %12s %12s %9s\n", "constraint", "items", "clauses", "literals", "bytes", "seconds");
+  for(unsigned int ii = 0; ii < sorted.size(); ii++) {
+    cost_row& r(sorted[ii].second);
+    fprintf(stderr, "%-28s %8d %10lld %12lld %12lld %9.3f\n", sorted[ii].first.c_str(), r.items, r.c.clauses, r.c.lits, r.c.bytes, r.c.time);
+  }
+}
+
+// One line per origin to -log_stats_csv; resolution is origin -1.
+static void write_cost_csv(void) {
+  if(!so.log_stats_csv)
+    return;
+  FILE* out = fopen(so.log_stats_csv, "w");
+  if(!out) {
+    perror(so.log_stats_csv);
+    return;
+  }
+  fprintf(out, "origin,constraint,clauses,literals,bytes,seconds\n");
+  fprintf(out, "-1,(resolution),%lld,%lld,%lld,%.6f\n", resolution_cost.clauses, resolution_cost.lits, resolution_cost.bytes, resolution_cost.time);
+  for(unsigned int ii = 0; ii < origin_costs.size(); ii++) {
+    origin_cost& c(origin_costs[ii]);
+    if(!c.clauses && c.time == 0)
+      continue;
+    fprintf(out, "%d,%s,%lld,%lld,%lld,%.6f\n", ii, origin_name(ii).c_str(), c.clauses, c.lits, c.bytes, c.time);
+  }
+  fclose(out);
+}
+
+// Whether a recycled var would leave no literal in the trace without
+// semantics: the literals of unnamed variables are written late.
+bool var_written(int v) {
+  return !so.logging || v >= (int) lit_pending.size() || !lit_pending[v];
+}
+
 void bind_ivar(int ivar_id, const std::string& sym) {
   if(!so.logging && !so.log_solution)
     return;
@@ -346,6 +952,45 @@ void bind_ivar(int ivar_id, const std::string& sym) {
   while(ivar_idents.size() <= ivar_id)
     ivar_idents.push_back(ivar_ident());
   ivar_idents[ivar_id] = ivar_ident(sym);
+
+  if(ivar_id < (int) pending_lits.size()) {
+    std::vector<int>& pending(pending_lits[ivar_id]);
+    for(unsigned int ii = 0; ii < pending.size(); ii++) {
+      if(lit_pending[pending[ii]]) {
+        write_lit(pending[ii]);
+        lit_pending[pending[ii]] = false;
+      }
+    }
+    std::vector<int>().swap(pending);
+  }
+}
+
+void new_vars(int v, int n) {
+  if(!so.logging)
+    return;
+  while((int) trace_var.size() < v)
+    trace_var.push_back(trace_vars++);
+  for(int vi = v; vi < v+n; vi++) {
+    if(vi < (int) trace_var.size())
+      trace_var[vi] = trace_vars++;
+    else
+      trace_var.push_back(trace_vars++);
+    ChannelInfo& ci = sat.c_info[vi];
+    if(ci.cons_type != 1)
+      continue;
+    if(ivar_is_bound(ci.cons_id)) {
+      write_lit(vi);
+      if(vi < (int) lit_pending.size())
+        lit_pending[vi] = false;
+    } else {
+      if(ci.cons_id >= pending_lits.size())
+        pending_lits.resize(ci.cons_id+1);
+      pending_lits[ci.cons_id].push_back(vi);
+      if(vi >= (int) lit_pending.size())
+        lit_pending.resize(vi+1);
+      lit_pending[vi] = true;
+    }
+  }
 }
 
 void bind_bvar(Lit l, const std::string& sym) {
@@ -356,7 +1001,7 @@ void bind_bvar(Lit l, const std::string& sym) {
   if(!so.logging)
     return;
   // Don't actually save; just write
-  fprintf(lit_file, "%d [%s %s 1]\n", var(l)+1, sym.c_str(), sign(l) ? ">=" : "<");
+  lit_writer.printf("%d [%s %s 1]\n", tvar(var(l))+1, sym.c_str(), sign(l) ? ">=" : "<");
 }
 
 const char* irt_string[] = {
@@ -391,9 +1036,9 @@ void bind_atom(Lit l, IntVar* v, IntRelType r, int k) {
   }
 
   if(sign(l)) {
-    fprintf(lit_file, "%d [%s %s %d]\n", var(l)+1, ivar_idents[v->var_id].sym.c_str(), irt_string[r], k);
+    lit_writer.printf("%d [%s %s %d]\n", tvar(var(l))+1, ivar_idents[v->var_id].sym.c_str(), irt_string[r], k);
   }  else {
-    fprintf(lit_file, "%d [%s %s %d]\n", var(l)+1, ivar_idents[v->var_id].sym.c_str(), irt_string[!r], k);
+    lit_writer.printf("%d [%s %s %d]\n", tvar(var(l))+1, ivar_idents[v->var_id].sym.c_str(), irt_string[!r], k);
   }
 }
 
@@ -401,7 +1046,7 @@ void bind_bool(Lit l, bool b) {
   if(!so.logging)
     return;
 
-  fprintf(lit_file, "%d [lit_True %s 1]\n", var(l)+1, sign(l)^b ? "<" : ">=");
+  lit_writer.printf("%d [lit_True %s 1]\n", tvar(var(l))+1, sign(l)^b ? "<" : ">=");
 }
 
 };
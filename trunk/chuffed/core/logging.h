@@ -29,9 +29,18 @@ void del(Clause* cl);
 
 void save_model(void);
 
+// Cost accounting (-log_stats)
+void name_origin(unsigned int origin, const std::string& name);
+void printStats(void);
+
 void finalize(void);
 
+// False if -log_check found a step it could not verify
+bool check_ok(void);
+
 // Variable naming
+void new_vars(int v, int n);
+bool var_written(int v);
 void bind_ivar(int ivar_id, const std::string& symbol);
 void bind_bvar(Lit l, const std::string& symbol);
 void bind_bool(Lit l, bool b);
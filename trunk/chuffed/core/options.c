@@ -12,6 +12,9 @@ Options::Options() :
 	, verbosity(0)
 	, print_sol(true)
 	, restart_base(1000000000)
+	, restart_type(0)
+	, restart_margin(125)
+	, restart_block(140)
 
 	, toggle_vsids(false)
 	, branch_random(false)
@@ -27,21 +30,32 @@ Options::Options() :
 
 	, sat_simplify(true)
 	, fd_simplify(true)
+	, free_lazy_lits(false)
 
 	, lazy(true)
 	, finesse(true)
 	, learn(true)
 	, vsids(false)
-#if PHASE_SAVING
+	, sat_heuristic(0)
 	, phase_saving(0)
-#endif
+	, target_phase(false)
+	, sol_phase(false)
+	, rephase_base(0)
 	, sort_learnt_level(false)
 	, one_watch(true)
+	, learnt_minimise(false)
+	, strengthen_bounds(false)
+	, chrono_backtrack(0)
 
 	, eager_limit(1000)
+	, lazy_channel(false)
 	, sat_var_limit(2000000)
 	, nof_learnts(100000)
 	, learnts_mlimit(500000000)
+	, lbd_core(2)
+	, lbd_tier2(6)
+	, reduce_base(0)
+	, reduce_inc(300)
 
 	, lang_ext_linear(false)
     
@@ -84,6 +98,15 @@ Options::Options() :
   , litfile("log.lit")
   , logfile("log.dres")
   , solfile("log.sol")
+  , log_binary(false)
+  , log_async(false)
+  , log_buffer(16)
+  , log_compress(0)
+  , log_trim(false)
+  , log_expl_cache(0)
+  , log_stats(false)
+  , log_stats_csv(NULL)
+  , log_check(false)
 #endif
 {}
 
@@ -121,6 +144,9 @@ void parseOptions(int& argc, char**& argv) {
 		parseIntArg(verbosity)
 		parseBoolArg(print_sol)
 		parseIntArg(restart_base)
+		parseIntArg(restart_type)
+		parseIntArg(restart_margin)
+		parseIntArg(restart_block)
 
 		parseBoolArg(toggle_vsids)
 		parseBoolArg(branch_random)
@@ -136,18 +162,32 @@ void parseOptions(int& argc, char**& argv) {
 
 		parseBoolArg(sat_simplify)
 		parseBoolArg(fd_simplify)
+		parseBoolArg(free_lazy_lits)
 
 		parseBoolArg(lazy)
 		parseBoolArg(finesse)
 		parseBoolArg(learn)
 		parseBoolArg(vsids)
+		parseIntArg(sat_heuristic)
+		parseIntArg(phase_saving)
+		parseBoolArg(target_phase)
+		parseBoolArg(sol_phase)
+		parseIntArg(rephase_base)
 		parseBoolArg(sort_learnt_level)
 		parseBoolArg(one_watch)
+		parseBoolArg(learnt_minimise)
+		parseBoolArg(strengthen_bounds)
+		parseIntArg(chrono_backtrack)
 
 		parseIntArg(eager_limit)
+		parseBoolArg(lazy_channel)
 		parseIntArg(sat_var_limit)
 		parseIntArg(nof_learnts)
 		parseIntArg(learnts_mlimit)
+		parseIntArg(lbd_core)
+		parseIntArg(lbd_tier2)
+		parseIntArg(reduce_base)
+		parseIntArg(reduce_inc)
 
 		parseBoolArg(lang_ext_linear)
 
@@ -189,6 +229,15 @@ void parseOptions(int& argc, char**& argv) {
     parseBoolArg(log_solution)
     parseStringArg(litfile)
     parseStringArg(logfile)
+    parseBoolArg(log_binary)
+    parseBoolArg(log_async)
+    parseIntArg(log_buffer)
+    parseIntArg(log_compress)
+    parseBoolArg(log_trim)
+    parseIntArg(log_expl_cache)
+    parseBoolArg(log_stats)
+    parseStringArg(log_stats_csv)
+    parseBoolArg(log_check)
 #endif
 		if (strcmp(argv[i], "-a") == 0) {
 			so.nof_solutions = 0;
@@ -212,7 +261,13 @@ void parseOptions(int& argc, char**& argv) {
 
 	if (so.ldsbta || so.ldsbad) so.ldsb = true;
 	if (so.ldsb) rassert(so.lazy);
+	if (so.ldsb) rassert(!so.lazy_channel);
 	if (so.mip_branch) rassert(so.mip);
+	if (so.restart_type < 0 || so.restart_type > 1) ERROR("-restart_type must be 0 or 1\n");
+#ifdef LOGGING
+	if (so.log_buffer < 1 || so.log_buffer > 1024) ERROR("-log_buffer must be in 1..1024\n");
+	if (so.log_compress < 0 || so.log_compress > 9) ERROR("-log_compress must be in 0..9\n");
+#endif
 	if (so.vsids) engine.branching->add(&sat);
 
 #ifndef PARALLEL
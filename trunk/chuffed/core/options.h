@@ -5,10 +5,6 @@
 #include <cstring>
 #include <chuffed/support/misc.h>
 
-// When enabled, there is a command-line option -phase_saving=n, defaults to
-// 0=none (1=some, 2=always, behaviour is exactly the same as MiniSat 2.2.0).
-#define PHASE_SAVING 0
-
 class Options {
 public:
 	// Solver options
@@ -18,6 +14,9 @@ public:
 	int verbosity;                   // Verbosity
 	bool print_sol;                  // Print solutions
 	int restart_base;                // How many conflicts before restart
+	int restart_type;                // 0 = Luby sequence over restart_base, 1 = Glucose style (LBD and trail averages)
+	int restart_margin;              // Glucose restarts: % by which recent LBDs must exceed the average
+	int restart_block;               // Glucose restarts: % of the average trail size which blocks a restart
 
 	// Search options
 	bool toggle_vsids;               // Alternate between search ann/vsids
@@ -38,22 +37,33 @@ public:
 	// Preprocessing options
 	bool sat_simplify;               // Simplify clause database at top level
 	bool fd_simplify;                // Simplify FD propagators at top level
+	bool free_lazy_lits;             // Free and reuse the lazy lits no longer used, after reduceDB and at top level
 
 	// Lazy clause options
 	bool lazy;                       // Use lazy clause
 	bool finesse;                    // Get better explanations sometimes
 	bool learn;                      // Learn clauses
 	bool vsids;                      // Use VSIDS as branching heuristic
-#if PHASE_SAVING
-	int phase_saving;                // Repeat same variable polarity (0=no, 1=recent, 2=always)
-#endif
+	int sat_heuristic;               // Activity of SAT vars with vsids: 0 = VSIDS, 1 = VMTF queue, 2 = LRB learning rate
+	int phase_saving;                // Repeat same variable polarity (0=no, 1=last level, 2=always), as in MiniSat 2.2.0
+	bool target_phase;               // Decide bool vars as in the longest conflict free trail since the last rephase
+	bool sol_phase;                  // Decide vars as in the last solution while they can be
+	int rephase_base;                // Conflicts between resets of the saved phases (0 = never), grows arithmetically
 	bool sort_learnt_level;          // Sort lits in learnt clause based on level
 	bool one_watch;                  // One watch learnt clauses
+	bool learnt_minimise;            // Recursively minimise learnt clauses
+	bool strengthen_bounds;          // Keep one bound lit per var and direction in learnt clauses
+	int chrono_backtrack;            // Backtrack one level instead of jumping back more than this many (0 = never)
 
 	int eager_limit;                 // Max var range before we use lazy lit generation
+	bool lazy_channel;               // Only keep the lits of eager vars in step with the domain once used
 	int sat_var_limit;               // Max number of sat vars before turning off lazy clause
 	int nof_learnts;                 // Learnt clause no. limit
 	int learnts_mlimit;              // Learnt clause mem limit
+	int lbd_core;                    // Max LBD of learnt clauses kept for good
+	int lbd_tier2;                   // Max LBD of learnt clauses kept while used
+	int reduce_base;                 // Conflicts before the first periodic learnt clause reduction (0 = never)
+	int reduce_inc;                  // Increase of the interval at each reduction
 
 	// Language of explanation extension options
 	bool lang_ext_linear;
@@ -119,6 +129,15 @@ public:
   const char* litfile;  // Where to record the literal semantics?
   const char* logfile;  // Where to record the proof trace?
   const char* solfile;  // Where to record the optimal solution?
+  bool log_binary;      // Write the proof trace in binary format?
+  bool log_async;       // Write the proof trace and literals from separate threads?
+  int log_buffer;       // Size of the writer thread's buffer, in Mb
+  int log_compress;     // gzip level for the trace and literal files, 0 = off
+  bool log_trim;        // Only write the steps the final conflict depends on?
+  int log_expl_cache;   // Number of logged explanations to keep for reuse, 0 = off
+  bool log_stats;       // Count logging costs per constraint?
+  const char* log_stats_csv;  // Where to write them per constraint item, if anywhere
+  bool log_check;       // Check the resolution steps on another thread while solving?
 #endif
 
 	Options();
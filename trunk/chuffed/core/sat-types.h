@@ -81,15 +81,22 @@ const lbool l_Undef = toLbool( 0);
 //=================================================================================================
 // Clause -- a simple class for representing a clause:
 
+// Tiers of learnt clauses, by LBD: local ones are reduced by activity, tier 2
+// ones are kept while they keep being used, core ones are kept for good
+enum { TIER_LOCAL = 0, TIER_2 = 1, TIER_CORE = 2 };
+
 class Clause {
 public:
 	unsigned int learnt    : 1;             // is it a learnt clause
 	unsigned int temp_expl : 1;             // is it a temporary explanation clause
+	unsigned int in_arena  : 1;             // allocated by the SAT clause arena
+	unsigned int reloced   : 1;             // moved by compaction, data holds the new address
+	unsigned int tier      : 2;             // tier of a learnt clause
+	unsigned int used      : 1;             // learnt clause used in analysis since the last reduction
 #ifdef LOGGING
   unsigned int logged    : 1;
-	unsigned int padding   : 5;
 #else
-	unsigned int padding   : 6;             // save some bits for other bitflags
+	unsigned int padding   : 1;             // save some bits for other bitflags
 #endif
 	unsigned int sz        : 24;            // the size of the clause
 #ifdef LOGGING
@@ -98,6 +105,7 @@ public:
 #endif
   Lit data[0];                            // the literals of the clause
 	float data2[0];
+	int data3[0];
 
 	// NOTE: This constructor cannot be used directly (doesn't allocate enough memory).
 	template<class V>
@@ -111,6 +119,7 @@ public:
     this->origin = logging::active_item;
 #endif
 		for (int i = 0; i < ps.size(); i++) data[i] = ps[i];
+		if (learnt) lbd() = sz;
 	}
 
 	// -- use this function instead:
@@ -121,13 +130,14 @@ public:
 	Lit          operator [] (int i) const   { return data[i]; }
 	operator const Lit* (void) const         { return data; }
 
-	float&       activity    ()              { return data2[sz]; }
+	float&       activity    ()              { return ((float*) (Lit*) data)[sz]; }
+	int&         lbd         ()              { return data3[sz+1]; }
 
 };
 
 template<class V>
 static Clause* Clause_new(const V& ps, bool learnt = false) {
-	int mem_size = sizeof(Clause) + ps.size() * sizeof(Lit) + (learnt ? 1 : 0) * sizeof(int);
+	int mem_size = sizeof(Clause) + ps.size() * sizeof(Lit) + (learnt ? 2 : 0) * sizeof(int);
 	void* mem = malloc(mem_size);
 	return new (mem) Clause(ps, learnt); }
 
@@ -140,11 +150,12 @@ struct LitFlags {
 	unsigned int decidable : 1;            // can be used as decision var
 	unsigned int uipable   : 1;            // can be used as head of learnt clause
 	unsigned int learnable : 1;            // can be used in tail of learnt clause
+	unsigned int lazy      : 1;            // eager int var lit not channelled until used
 #ifdef LOGGING
   unsigned int no_log    : 1;
-  unsigned int padding   : 4;
+  unsigned int padding   : 3;
 #else
-	unsigned int padding   : 5;            // leave some space for other flags
+	unsigned int padding   : 4;            // leave some space for other flags
 #endif
 
 	LitFlags(char f) { *((char*) this) = f; }
@@ -171,21 +182,22 @@ const ChannelInfo ci_null(0,0,0,0);
 
 //=================================================================================================
 // WatchElem -- watch list element:
-// relies on all pointers being aligned to multiples of 4
+// type 1: absorbed binary clause, type 2: FD propagator, type 3: long clause,
+// given by its ClauseArena::Ref, with a blocker literal (one of the clause's
+// other literals, so the clause is satisfied if it is true)
 
 class WatchElem {
 public:
 	union {
-		Clause *pt;                               // clause pointer
 		struct {
-			unsigned int type : 2;                  // which type of watch elem if it's not a clause pointer
+			unsigned int type : 2;                  // which type of watch elem
 			unsigned int d1   : 30;                 // data 1
 			unsigned int d2   : 32;                 // data 2
 		} d;
 		int64_t a;
 	};
 	WatchElem() : a(0) {}
-	WatchElem(Clause *c) : pt(c) { if (sizeof(Clause *) == 4) d.d2 = 0; }
+	WatchElem(unsigned int ref, Lit blocker) : a(0) { d.type = 3; d.d1 = ref; d.d2 = toInt(blocker); }
 #ifndef LOGGING
 	WatchElem(Lit p) { d.type = 1; d.d2 = toInt(p); }
 #else
@@ -219,12 +231,13 @@ public:
   }
 	Reason(Clause *c) : pt(c) { if (sizeof(Clause *) == 4) d.d2 = 0; }
 	Reason(int prop_id, int inf_id) { d.type = 1; d.d1 = inf_id; d.d2 = prop_id; }
-	Reason(Lit p) {
-#ifdef LOGGING
-    d.d2 = logging::active_item;
+#ifndef LOGGING
+	Reason(Lit p) { d.type = 2; d.d1 = toInt(p); }
+#else
+  // An inline binary clause (~p implies the inferred literal), along with
+  // the clause's ident in the trace.
+  Reason(Lit p, unsigned int ident) { d.type = 2; d.d1 = toInt(p); d.d2 = ident; }
 #endif
-    d.type = 2; d.d1 = toInt(p);
-  }
 	Reason(Lit p, Lit q) {
 #ifdef LOGGING
     NEVER;
@@ -26,8 +26,26 @@ cassert(sizeof(Reason) == 8);
 
 
 
-inline void SAT::insertVarOrder(int x) {
-	if (!order_heap.inHeap(x) && flags[x].decidable) order_heap.insert(x);
+inline void SAT::vmtfEnqueue(int x) {
+	vmtf_prev[x] = vmtf_last;
+	vmtf_next[x] = -1;
+	if (vmtf_last >= 0) vmtf_next[vmtf_last] = x;
+	vmtf_last = x;
+	vmtf_stamp[x] = ++vmtf_stamps;
+}
+
+inline void SAT::lrbAssign(int x) {
+	lrb_assigned[x] = engine.conflicts;
+	lrb_participated[x] = 0;
+}
+
+// The reward is the share of the conflicts while x was assigned which it
+// took part in.
+inline void SAT::lrbUnassign(int x) {
+	long long int interval = engine.conflicts - lrb_assigned[x];
+	if (interval == 0) return;
+	activity[x] += lr_alpha * ((double) lrb_participated[x] / interval - activity[x]);
+	if (order_heap.inHeap(x)) order_heap.update(x);
 }
 
 inline void SAT::setConfl(Lit p, Lit q) {
@@ -41,18 +59,24 @@ inline void SAT::setConfl(Lit p, Lit q) {
 	confl = short_confl;
 }
 
-inline void SAT::untrailToPos(vec<Lit>& t, int p) {
-	int dl = decisionLevel();
+#ifdef LOGGING
+inline void SAT::setConfl(Lit p, Lit q, unsigned int ident) {
+	(*bin_confl)[0] = p;
+	(*bin_confl)[1] = q;
+	bin_confl->ident = ident;
+	confl = bin_confl;
+}
+#endif
 
+inline void SAT::untrailToPos(vec<Lit>& t, int p, bool save_phase) {
 	for (int i = t.size(); i-- > p; ) {
 		int x = var(t[i]);
 		assigns[x] = toInt(l_Undef);
-#if PHASE_SAVING
-		if (so.phase_saving >= 1 || (so.phase_saving == 1 && dl >= l0))
-			polarity[x] = sign(t[i]);
-#endif
+		if (save_phase) polarity[x] = sign(t[i]);
+		if (so.sat_heuristic == 2) lrbUnassign(x);
 		insertVarOrder(x);
 	}
+	num_assigned -= t.size() - p;
 	t.resize(p);
 }
 
@@ -66,10 +90,28 @@ SAT::SAT() :
 	, trail(1)
 	, qhead(1,0)
 	, rtrail(1)
+	, chrono_lits(1)
 	, confl(NULL)
+	, explaining(false)
+	, lbd_stamp(0)
 	, var_inc(1)
+	, ivar_inc(1)
 	, cla_inc(1)
 	, order_heap(VarOrderLt(activity))
+	, target_assigned(0)
+	, best_assigned(0)
+	, next_rephase(0)
+	, rephases(0)
+	, vmtf_last(-1)
+	, vmtf_search(-1)
+	, vmtf_stamps(0)
+	, lr_alpha(0.4)
+	, lbd_fast(0)
+	, lbd_slow(0)
+	, trail_slow(0)
+	, restart_samples(0)
+	, restart_conflicts(0)
+	, num_assigned(0)
 	, bin_clauses(0)
 	, tern_clauses(0)
 	, long_clauses(0)
@@ -78,6 +120,15 @@ SAT::SAT() :
 	, back_jumps(0)
 	, nrestarts(0)
 	, next_simp_db(100000)
+	, compactions(0)
+	, next_reduce_db(0)
+	, reductions(0)
+	, bound_lits_removed(0)
+	, blocked_restarts(0)
+	, chrono_backtracks(0)
+	, chrono_reimplied(0)
+	, lazy_vars_freed(0)
+	, lazy_vars_reused(0)
 	, clauses_literals(0)
 	, learnts_literals(0)
 	, max_literals(0)
@@ -89,6 +140,7 @@ SAT::SAT() :
 	, learnt_len_el(10)
 	, learnt_len_occ(MAX_SHARE_LEN,learnt_len_el*1000/MAX_SHARE_LEN)
 {
+	for (int i = 0; i < 3; i++) tier_learnts[i] = tier_promotions[i] = tier_deletions[i] = 0;
 	newVar(); enqueue(Lit(0,1));
 	newVar(); enqueue(Lit(1,0));
 #ifdef LOGGING
@@ -99,19 +151,35 @@ SAT::SAT() :
 	short_expl = (Clause*) malloc(sizeof(Clause) + 3 * sizeof(Lit));
 	short_confl = (Clause*) malloc(sizeof(Clause) + 2 * sizeof(Lit));
 	short_expl->clearFlags();
+#ifndef LOGGING
   short_expl->temp_expl = 1;
+#else
+  // short_expl stands for an inline binary clause, which is already logged
+  short_expl->ident = 0;
+  short_expl->origin = 0;
+#endif
 	short_confl->clearFlags();
 	short_confl->sz = 2;
+#ifdef LOGGING
+	bin_confl = (Clause*) malloc(sizeof(Clause) + 2 * sizeof(Lit));
+	bin_confl->clearFlags();
+	bin_confl->sz = 2;
+	bin_confl->origin = 0;
+#endif
 }
 
 SAT::~SAT() {
-	for (int i = 0; i < clauses.size(); i++) free(clauses[i]);
-	for (int i = 0; i < learnts.size(); i++) free(learnts[i]);
+	for (int i = 0; i < clauses.size(); i++) if (!clauses[i]->in_arena) free(clauses[i]);
+	for (int i = 0; i < learnts.size(); i++) if (!learnts[i]->in_arena) free(learnts[i]);
 }
 
 void SAT::init() {
 	orig_cutoff = nVars();
 	ivseen.growTo(engine.vars.size(), false);
+	bound_lit.growTo(2*engine.vars.size(), 0);
+	next_reduce_db = so.reduce_base;
+	next_rephase = so.rephase_base;
+	for (int i = 0; i < nVars(); i++) orig_phase[i] = polarity[i];
 }
 
 int SAT::newVar(int n, ChannelInfo ci) {
@@ -122,16 +190,29 @@ int SAT::newVar(int n, ChannelInfo ci) {
 	assigns  .growBy(n, toInt(l_Undef));
 	reason   .growBy(n, NULL);
 	trailpos .growBy(n, -1);
+	level    .growBy(n, 0);
 	seen     .growBy(n, 0);
 	activity .growBy(n, 0);
 	polarity .growBy(n, 1);
+	orig_phase.growBy(n, 1);
+	target_phase.growBy(n, 2);
+	best_phase.growBy(n, 2);
+	vmtf_prev.growBy(n, -1);
+	vmtf_next.growBy(n, -1);
+	vmtf_stamp.growBy(n, 0);
+	lrb_assigned.growBy(n, 0);
+	lrb_participated.growBy(n, 0);
 	flags    .growBy(n, 7);
 
 	for (int i = 0; i < n; i++) {
 		c_info.push(ci);
 		ci.val++;
+		vmtfEnqueue(s+i);
 		insertVarOrder(s+i);
 	}
+#ifdef LOGGING
+	logging::new_vars(s, n);
+#endif
 
 	return s;
 }
@@ -141,40 +222,75 @@ int SAT::getLazyVar(ChannelInfo ci) {
 	if (var_free_list.size()) {
 		v = var_free_list.last();
 		var_free_list.pop();
-		fprintf(stderr, "reuse %d\n", v);
 		assert(assigns[v] == toInt(l_Undef));
 		assert(watches[2*v].size() == 0);
 		assert(watches[2*v+1].size() == 0);
-		assert(num_used[v] == 0);
+		assert(num_used[v-orig_cutoff] == 0);
 		c_info[v] = ci;
+		reason[v] = NULL;
+		seen[v] = 0;
 		activity[v] = 0;
 		polarity[v] = 1;
+		orig_phase[v] = 1;
+		target_phase[v] = best_phase[v] = 2;
+		lrb_participated[v] = 0;
 		flags[v] = 7;
+		insertVarOrder(v);
+		lazy_vars_reused++;
+#ifdef LOGGING
+		logging::new_vars(v, 1);
+#endif
 	} else {
 		v = newVar(1, ci);
 		num_used.push(0);
 	}
 //	flags[v].setDecidable(false);
+	if (so.free_lazy_lits) lazy_unused.push(v);
 	return v;
 }
 
 void SAT::removeLazyVar(int v) {
-	return;
 	ChannelInfo& ci = c_info[v];
 	assert(assigns[v] == toInt(l_Undef));
 	assert(watches[2*v].size() == 0);
 	assert(watches[2*v+1].size() == 0);
-	fprintf(stderr, "free %d\n", v);
+	assert(num_used[v-orig_cutoff] == 0);
 	var_free_list.push(v);
 	if (ci.cons_type == 1) {
 		((IntVarLL*) engine.vars[ci.cons_id])->freeLazyVar(ci.val);
 	} else if (ci.cons_type == 2) {
 		engine.propagators[ci.cons_id]->freeLazyVar(ci.val);
 	} else NEVER;
+	ci = ci_null;
+	flags[v].setDecidable(false);
+}
+
+// Frees the lazy lits which no clause or reason uses any more, so that the
+// lits of IntVarLLs don't pile up over a long run.  Lits given out by
+// getLit may be held by propagators, so they are kept for good.  Assigned
+// lits stay too.  An unassigned lit was unassigned at every level above,
+// so no trailed IntVarLL bound points at it and it can go at any level.
+void SAT::collectLazyVars() {
+	for (int i = 0; i < lazy_unused.size(); i++) {
+		int v = lazy_unused[i];
+		if (c_info[v].cons_type != 1 || num_used[v-orig_cutoff] || assigns[v]) continue;
+		if (watches[2*v].size() || watches[2*v+1].size()) continue;
+#ifdef LOGGING
+		if (!logging::var_written(v)) continue;
+#endif
+		removeLazyVar(v);
+		lazy_vars_freed++;
+	}
+	lazy_unused.clear();
+}
+
+void SAT::useLazyLit(Lit p) {
+	((IntVarEL*) engine.vars[c_info[var(p)].cons_id])->useLit(p);
 }
 
 // FIXME: Special case this.
 void SAT::addClause(Lit p, Lit q) {
+	useLit(p); useLit(q);
 	if (value(p) == l_True || value(q) == l_True) return;
 #ifndef LOGGING
 	if (value(p) == l_False && value(q) == l_False) {
@@ -202,6 +318,7 @@ void SAT::addClause(Lit p, Lit q) {
 
 void SAT::addClause(vec<Lit>& ps, bool one_watch) {
 	int i, j;
+	for (i = 0; i < ps.size(); i++) useLit(ps[i]);
 #ifndef LOGGING
 	for (i = j = 0; i < ps.size(); i++) {
 		if (value(ps[i]) == l_True) return;
@@ -223,7 +340,7 @@ void SAT::addClause(vec<Lit>& ps, bool one_watch) {
     TL_FAIL();
   }
 #endif
-	addClause(*Clause_new(ps), one_watch);
+	addClause(ps.size() > 2 ? *ca.alloc(ps, false) : *Clause_new(ps), one_watch);
 }
 
 void SAT::addClause(Clause& c, bool one_watch) {
@@ -238,7 +355,7 @@ void SAT::addClause(Clause& c, bool one_watch) {
     Reason r; r.d.d2 = c.origin;
 		if (value(c[0]) == l_Undef) enqueue(c[0], r);
 #endif
-		free(&c);
+		freeClause(c);
 		return;
 	}
 	if (!c.learnt) {
@@ -249,21 +366,46 @@ void SAT::addClause(Clause& c, bool one_watch) {
 
 	// Mark lazy lits which are used
 	if (c.learnt) for (int i = 0; i < c.size(); i++) incVarUse(var(c[i]));
+	for (int i = 0; i < c.size(); i++) useLit(c[i]);
 
 #ifndef LOGGING
 	if (c.size() == 2) {
 		if (!one_watch) watches[toInt(~c[0])].push(c[1]);
 		watches[toInt(~c[1])].push(c[0]);
-		if (!c.learnt) free(&c);
+		if (!c.learnt) freeClause(c);
 		return;
 	}
+#else
+	// Binary clauses are logged now, and carry their ident in the watches.
+	// A learnt one gives up its ident, so freeing it from the rtrail doesn't
+	// delete the clause from the trace.
+	if (c.size() == 2) {
+		unsigned int ident = so.logging ? logging::intro(&c) : 0;
+		if (ident < BIN_IDENT_LIMIT) {
+			if (!one_watch) watches[toInt(~c[0])].push(WatchElem(c[1], ident));
+			watches[toInt(~c[1])].push(WatchElem(c[0], ident));
+			if (!c.learnt) freeClause(c);
+			else c.ident = 0;
+			return;
+		}
+	}
 #endif
-	if (!one_watch) watches[toInt(~c[0])].push(&c);
-	watches[toInt(~c[1])].push(&c);
-	if (c.learnt) learnts_literals += c.size();
-	else            clauses_literals += c.size();
-	if (c.learnt) learnts.push(&c);
-	else            clauses.push(&c);
+	// Watched clauses must be in the arena.  Learnt ones may also be reasons,
+	// so they are made there; problem clauses are owned by the database and
+	// can be moved.
+	Clause *cp = &c;
+	if (!c.in_arena) {
+		assert(!c.learnt);
+		cp = ca.copy(&c);
+		free(&c);
+	}
+	ClauseArena::Ref cr = ca.ref(cp);
+	if (!one_watch) watches[toInt(~(*cp)[0])].push(WatchElem(cr, (*cp)[1]));
+	watches[toInt(~(*cp)[1])].push(WatchElem(cr, (*cp)[0]));
+	if (cp->learnt) learnts_literals += cp->size();
+	else             clauses_literals += cp->size();
+	if (cp->learnt) learnts.push(cp);
+	else             clauses.push(cp);
 }
 
 void SAT::removeClause(Clause& c) {
@@ -274,21 +416,80 @@ void SAT::removeClause(Clause& c) {
   }
 #endif
 	assert(c.size() > 1);
-	watches[toInt(~c[0])].remove(&c);
-	watches[toInt(~c[1])].remove(&c);
+	ClauseArena::Ref cr = ca.ref(&c);
+	for (int k = 0; k < 2; k++) {
+		vec<WatchElem>& ws = watches[toInt(~c[k])];
+		for (int i = 0; i < ws.size(); i++) {
+			if (ws[i].d.type == 3 && ws[i].d.d1 == cr) { ws[i] = ws.last(); ws.pop(); break; }
+		}
+	}
 	if (c.learnt) learnts_literals -= c.size();
 	else          clauses_literals -= c.size();
 
 	if (c.learnt) for (int i = 0; i < c.size(); i++) decVarUse(var(c[i]));
 
-	free(&c);
+	freeClause(c);
+}
+
+void SAT::freeClause(Clause& c) {
+	if (c.in_arena) ca.free(&c);
+	else free(&c);
+}
+
+// Compact the arena once a fifth of it is freed clauses, or it has overflowed
+void SAT::checkGarbage() {
+	if (ca.wastedBytes() > ca.size() / 5 || ca.overflowed()) relocAll();
+}
+
+static inline void reloc(Clause*& c, ClauseArena& to) {
+	if (!c->in_arena) return;
+	c = c->reloced ? ClauseArena::forward(c) : to.reloc(c);
+}
+
+// Move the live clauses into a fresh arena.  Every reference into the arena
+// is in the watches, the reasons of assigned vars and of missed_lits, the
+// rtrail, the clause lists or confl.
+void SAT::relocAll() {
+	ClauseArena to;
+	size_t live = ca.size() - ca.wastedBytes();
+	to.reserve(live + live / 2);
+
+	// Watches first, so clauses end up in the order propagation visits them
+	for (int i = 0; i < watches.size(); i++) {
+		vec<WatchElem>& ws = watches[i];
+		for (int j = 0; j < ws.size(); j++) {
+			if (ws[j].d.type != 3) continue;
+			Clause *c = ca.deref(ws[j].d.d1);
+			reloc(c, to);
+			ws[j].d.d1 = to.ref(c);
+		}
+	}
+	for (int l = 0; l < trail.size(); l++) {
+		for (int i = 0; i < trail[l].size(); i++) {
+			Reason& r = reason[var(trail[l][i])];
+			if (r.d.type == 0 && r.pt) reloc(r.pt, to);
+		}
+	}
+	for (int l = 0; l < rtrail.size(); l++) {
+		for (int i = 0; i < rtrail[l].size(); i++) reloc(rtrail[l][i], to);
+	}
+	for (int i = 0; i < learnts.size(); i++) reloc(learnts[i], to);
+	for (int i = 0; i < clauses.size(); i++) reloc(clauses[i], to);
+	for (int i = 0; i < missed_reasons.size(); i++) {
+		if (missed_reasons[i].d.type == 0) reloc(missed_reasons[i].pt, to);
+	}
+	if (confl) reloc(confl, to);
+
+	ca.clear();
+	to.moveTo(ca);
+	compactions++;
 }
 
 void SAT::topLevelCleanUp() {
   assert(decisionLevel() == 0);
 
 #ifndef LOGGING
-	for (int i = rtrail[0].size(); i-- > 0; ) free(rtrail[0][i]);
+	for (int i = rtrail[0].size(); i-- > 0; ) freeClause(*rtrail[0][i]);
 	rtrail[0].clear();
 #endif
 
@@ -305,6 +506,7 @@ void SAT::topLevelCleanUp() {
 	if (so.sat_simplify && propagations >= next_simp_db) simplifyDB();
 
 	trail[0].clear();
+	if (so.free_lazy_lits && lazy_unused.size()) collectLazyVars();
 	qhead[0] = 0;
 
 }
@@ -317,6 +519,7 @@ void SAT::simplifyDB() {
 	}
   learnts.resize(j);
 	next_simp_db = propagations + clauses_literals + learnts_literals;
+	checkGarbage();
 }
 
 bool SAT::simplify(Clause& c) {
@@ -326,23 +529,34 @@ bool SAT::simplify(Clause& c) {
 #endif
 	if (value(c[0]) == l_True) return true;
 	if (value(c[1]) == l_True) return true;
+	// Lits are swapped rather than copied down, so a clause found satisfied
+	// part way still holds the lits whose use counts removeClause drops.
 	int i, j;
 	for (i = j = 2; i < c.size(); i++) {
 #ifndef LOGGING
 		if (value(c[i]) == l_True) return true;
-		if (value(c[i]) == l_Undef) c[j++] = c[i];
+		if (value(c[i]) == l_Undef) std::swap(c[j++], c[i]);
 #else
     if (value(c[i]) == l_True) {
       logging::antecedents.clear();
       return true;
     }
     if (value(c[i]) == l_Undef)
-      c[j++] = c[i];
+      std::swap(c[j++], c[i]);
     else if(so.logging)
       logging::push_unit(logging::antecedents, ~c[i]);
 #endif
 	}
-	c.sz = j;
+	int old_sz = c.sz;
+	if (c.learnt) {
+		// The activity and LBD follow the lits
+		float act = c.activity();
+		int lbd = c.lbd();
+		c.sz = j;
+		c.activity() = act;
+		c.lbd() = std::min(lbd, j);
+	} else c.sz = j;
+	if (c.in_arena) ca.shrunk(&c, old_sz);
 #ifdef LOGGING
   if(so.logging) {
     if(logging::antecedents.size() > 0) {
@@ -367,8 +581,11 @@ void SAT::enqueue(Lit p, Reason r) {
 	int v = var(p);
 	assigns [v] = toInt(lbool(!sign(p)));
 	trailpos[v] = engine.trailPos();
+	level   [v] = decisionLevel();
 	reason  [v] = r;
+	if (so.sat_heuristic == 2) lrbAssign(v);
 	trail.last().push(p);
+	num_assigned++;
 	ChannelInfo& ci = c_info[v];
 	if (ci.cons_type == 1) engine.vars[ci.cons_id]->channel(ci.val, ci.val_type, sign(p));
 }
@@ -392,8 +609,11 @@ void SAT::cEnqueue(Lit p, Reason r) {
 	}
 	assigns [v] = toInt(lbool(!sign(p)));
 	trailpos[v] = engine.trailPos();
+	level   [v] = decisionLevel();
 	reason  [v] = r;
+	if (so.sat_heuristic == 2) lrbAssign(v);
 	trail.last().push(p);
+	num_assigned++;
 }
 
 
@@ -401,37 +621,113 @@ void SAT::aEnqueue(Lit p, Reason r, int l) {
 	assert(value(p) == l_Undef);
 	int v = var(p);
 	assigns [v] = toInt(lbool(!sign(p)));
-	trailpos[v] = engine.trail_lim[l]-1;
+	trailpos[v] = l < decisionLevel() ? engine.trail_lim[l]-1 : engine.trailPos();
+	level   [v] = l;
 	reason  [v] = r;
+	if (so.sat_heuristic == 2) lrbAssign(v);
 	trail[l].push(p);
+	num_assigned++;
 }
 
 void SAT::btToLevel(int level) {
   if (decisionLevel() <= level) return;
 
+	if (so.target_phase || so.rephase_base) updatePhases();
 	for (int l = trail.size(); l-- > level+1; ) {
-		untrailToPos(trail[l], 0);
+		untrailToPos(trail[l], 0, so.phase_saving == 2 || (so.phase_saving == 1 && l == trail.size()-1));
 		for (int i = rtrail[l].size(); i--; ) {
 #ifdef LOGGING
       logging::del(rtrail[l][i]);
 #endif
-			free(rtrail[l][i]);
+			freeClause(*rtrail[l][i]);
 		}
+		collectMissed(chrono_lits[l]);
 	}
   trail.resize(level+1);
 	qhead.resize(level+1);
 	rtrail.resize(level+1);
+	chrono_lits.resize(level+1);
 
 	engine.btToLevel(level);
 	if (so.mip) mip->btToLevel(level);
 
+	// During conflict analysis, analyze implies them once the learnt clause
+	// is asserted
+	if (!confl) reimplyMissed();
 }
 
 void SAT::btToPos(int sat_pos, int core_pos) {
-	untrailToPos(trail.last(), sat_pos);
+	untrailToPos(trail.last(), sat_pos, so.phase_saving >= 1);
+	collectMissed(chrono_lits.last());
 	engine.btToPos(core_pos);
 }
 
+// Moves the lits which have been undone to missed_lits, along with their
+// reasons, which unassigning leaves in place.
+void SAT::collectMissed(vec<Lit>& lits) {
+	int j = 0;
+	for (int i = 0; i < lits.size(); i++) {
+		Lit p = lits[i];
+		if (value(p) == l_True) { lits[j++] = p; continue; }
+		missed_lits.push(p);
+		missed_reasons.push(reason[var(p)]);
+	}
+	lits.shrink(lits.size()-j);
+}
+
+// A lit asserted by chronological backtracking sits above the level it is
+// implied at, so a backtrack in between can undo it while the rest of its
+// clause stays false.  The clause would then never propagate it again, so
+// it is implied again here, at the new level.  If it has since been set
+// false, the clause is a conflict, and the lits after it are left for the
+// reimplyMissed in analyze.
+void SAT::reimplyMissed() {
+	for (int i = 0; i < missed_lits.size(); i++) {
+		Lit p = missed_lits[i];
+		Reason r = missed_reasons[i];
+		if (value(p) == l_True) continue;
+		if (r.d.type == 2) {
+			if (value(toLit(r.d.d1)) != l_False) continue;
+		} else {
+			assert(r.d.type == 0);
+			Clause& c = *r.pt;
+			int j = 0;
+			while (j < c.size() && (c[j] == p || value(c[j]) == l_False)) j++;
+			if (j < c.size()) continue;
+		}
+		if (value(p) == l_False) {
+#ifndef LOGGING
+			if (r.d.type == 2) setConfl(p, toLit(r.d.d1));
+#else
+			if (r.d.type == 2) setConfl(p, toLit(r.d.d1), r.d.d2);
+#endif
+			else confl = r.pt;
+			engine.async_fail = true;
+			int j = 0;
+			for (int k = i+1; k < missed_lits.size(); k++, j++) {
+				missed_lits[j] = missed_lits[k];
+				missed_reasons[j] = missed_reasons[k];
+			}
+			missed_lits.shrink(missed_lits.size()-j);
+			missed_reasons.shrink(missed_reasons.size()-j);
+			return;
+		}
+		enqueue(p, r);
+		if (decisionLevel() > 0) chrono_lits.last().push(p);
+		chrono_reimplied++;
+	}
+	missed_lits.clear();
+	missed_reasons.clear();
+}
+
+// Whether c is the reason of a lit still to be implied again
+bool SAT::isMissedReason(Clause& c) const {
+	for (int i = 0; i < missed_reasons.size(); i++) {
+		if (missed_reasons[i].d.type == 0 && missed_reasons[i].pt == &c) return true;
+	}
+	return false;
+}
+
 
 // Propagator methods:
 
@@ -459,9 +755,15 @@ bool SAT::propagate() {
 				*j++ = *i++;
 				Lit q = toLit(we.d.d2);
 				switch (toInt(value(q))) {
+#ifndef LOGGING
 					case 0: enqueue(q, ~p); break;
 					case -1:
 						setConfl(q, ~p);
+#else
+					case 0: enqueue(q, Reason(~p, we.d.d1)); break;
+					case -1:
+						setConfl(q, ~p, we.d.d1);
+#endif
 						qhead = trail.size();
 						while (i < end) *j++ = *i++;
 						break;
@@ -476,36 +778,45 @@ bool SAT::propagate() {
 				continue;
 			}
 			default:
-				Clause& c = *we.pt;
-				i++;
-
-				// Check if already satisfied
-				if (value(c[0]) == l_True || value(c[1]) == l_True) {
-					*j++ = &c;
+				// Satisfied by the blocker, no need to look at the clause
+				Lit blocker = toLit(we.d.d2);
+				if (value(blocker) == l_True) {
+					*j++ = *i++;
 					continue;
 				}
+				ClauseArena::Ref cr = we.d.d1;
+				Clause& c = *ca.deref(cr);
+				i++;
 
 				Lit false_lit = ~p;
 
 				// Make sure the false literal is data[1]:
 				if (c[0] == false_lit) c[0] = c[1], c[1] = false_lit;
 
+				// Check if already satisfied by the other watch, which becomes the blocker
+				Lit first = c[0];
+				WatchElem w(cr, first);
+				if (first != blocker && value(first) == l_True) {
+					*j++ = w;
+					continue;
+				}
+
 				// Look for new watch:
 				for (int k = 2; k < c.size(); k++)
 					if (value(c[k]) != l_False) {
 						c[1] = c[k]; c[k] = false_lit;
-						watches[toInt(~c[1])].push(&c);
+						watches[toInt(~c[1])].push(w);
 						goto FoundWatch;
 					}
 
 				// Did not find watch -- clause is unit under assignment:
-				*j++ = &c;
-				if (value(c[0]) == l_False) {
+				*j++ = w;
+				if (value(first) == l_False) {
 					confl = &c;
 					qhead = trail.size();
 					while (i < end)	*j++ = *i++;
 				} else {
-					enqueue(c[0], &c);
+					enqueue(first, &c);
 				}
 				FoundWatch:;
 			}
@@ -518,21 +829,80 @@ bool SAT::propagate() {
 }
 
 struct activity_lt { bool operator() (Clause* x, Clause* y) { return x->activity() < y->activity(); } };
-void SAT::reduceDB() {
-  int i, j;
 
-	std::sort((Clause**) learnts, (Clause**) learnts + learnts.size(), activity_lt());
+// Learnt clauses are kept in tiers by LBD.  Core clauses stay, tier 2 clauses
+// which have not been used since the last reduction drop to local, and the
+// less active half of the local clauses which have not been used either is
+// deleted.  When the nof_learnts or learnts_mlimit limit is hit, tier 2
+// counts as local and used clauses are not spared, so the less active half
+// of everything but the core goes.
+void SAT::reduceDB(bool forced) {
+	int i, j;
+	vec<Clause*> local;
 
-  for (i = j = 0; i < learnts.size()/2; i++) {
-		if (!locked(*learnts[i])) removeClause(*learnts[i]);
-		else learnts[j++] = learnts[i];
-  }
-  for (; i < learnts.size(); i++) {
-		learnts[j++] = learnts[i];
-  }
-  learnts.resize(j);
+	reductions++;
+	for (i = j = 0; i < learnts.size(); i++) {
+		Clause& c = *learnts[i];
+		if (c.tier == TIER_2 && !c.used) c.tier = TIER_LOCAL;
+		if (c.tier != TIER_CORE && (forced || (c.tier == TIER_LOCAL && !c.used))) local.push(&c);
+		else learnts[j++] = &c;
+		c.used = 0;
+	}
+	learnts.resize(j);
+
+	std::sort((Clause**) local, (Clause**) local + local.size(), activity_lt());
+
+	int pruned = 0;
+	for (i = 0; i < local.size(); i++) {
+		Clause& c = *local[i];
+		// confl can be a learnt clause which reimplyMissed found false, and
+		// the lits after it still need their clauses
+		if (i < local.size()/2 && !locked(c) && &c != confl && !isMissedReason(c)) {
+			tier_deletions[c.tier]++;
+			removeClause(c);
+			pruned++;
+		} else learnts.push(&c);
+	}
+
+	next_reduce_db = engine.conflicts + so.reduce_base + so.reduce_inc * reductions;
+	if (so.free_lazy_lits && lazy_unused.size()) collectLazyVars();
+
+	if (so.verbosity >= 1) printf("%% Pruned %d learnt clauses\n", pruned);
+	checkGarbage();
+}
 
-	if (so.verbosity >= 1) printf("%% Pruned %d learnt clauses\n", i-j);
+// Glucose style restarts: restart once the recent learnt clauses are clearly
+// worse (higher LBD) than usual, unless the trail is much longer than usual,
+// which suggests the search is close to a solution.  Blocking resets the
+// count of conflicts since the last restart, so a restart needs another
+// restart_min_confls conflicts.
+
+static const double lbd_fast_decay = 1.0 / 32;
+static const double slow_decay = 1.0 / 16384;
+static const int restart_min_confls = 50;
+static const int block_after_confls = 10000;
+
+// The first samples weigh more, so an average does not start biased towards 0
+static inline void updateAvg(double& avg, double x, double decay, long long int samples) {
+	double d = 1.0 / samples;
+	avg += (d > decay ? d : decay) * (x - avg);
+}
+
+void SAT::updateRestartAvgs(int lbd) {
+	restart_samples++;
+	restart_conflicts++;
+	if (engine.conflicts > block_after_confls && restart_conflicts >= restart_min_confls
+			&& 100.0 * num_assigned > so.restart_block * trail_slow) {
+		restart_conflicts = 0;
+		blocked_restarts++;
+	}
+	updateAvg(lbd_fast, lbd, lbd_fast_decay, restart_samples);
+	updateAvg(lbd_slow, lbd, slow_decay, restart_samples);
+	updateAvg(trail_slow, num_assigned, slow_decay, restart_samples);
+}
+
+bool SAT::restartDue() const {
+	return restart_conflicts >= restart_min_confls && 100.0 * lbd_fast > so.restart_margin * lbd_slow;
 }
 
 void SAT::printStats() {
@@ -541,21 +911,119 @@ void SAT::printStats() {
 	fprintf(stderr, "%d orig tern clauses\n", tern_clauses);
 	fprintf(stderr, "%d orig long clauses (avg. len. %.2f)\n", long_clauses, long_clauses ? (double) (clauses_literals - 3*tern_clauses) / long_clauses : 0);
 	fprintf(stderr, "%d learnt clauses (avg. len. %.2f)\n", learnts.size(), learnts.size() ? (double) learnts_literals / learnts.size() : 0);
+	int in_tier[3] = {0, 0, 0};
+	for (int i = 0; i < learnts.size(); i++) in_tier[learnts[i]->tier]++;
+	const char* tier_name[3] = {"local", "tier 2", "core"};
+	for (int t = 3; t-- > 0; ) {
+		fprintf(stderr, "%d %s learnt clauses (%lld learnt, %lld promoted, %lld deleted)\n", in_tier[t], tier_name[t], tier_learnts[t], tier_promotions[t], tier_deletions[t]);
+	}
+	fprintf(stderr, "%lld learnt clause reductions\n", reductions);
+	if (so.strengthen_bounds) fprintf(stderr, "%lld bound lits dropped from learnt clauses\n", bound_lits_removed);
+	if (so.learnt_minimise) fprintf(stderr, "%.2f%% of learnt clause lits minimised away\n", max_literals ? 100.0 * (max_literals - tot_literals) / max_literals : 0);
 	fprintf(stderr, "%lld SAT propagations\n", propagations);
 	fprintf(stderr, "%lld back jumps\n", back_jumps);
 	fprintf(stderr, "%lld natural restarts\n", nrestarts);
+	if (so.rephase_base) fprintf(stderr, "%lld rephases\n", rephases);
+	if (so.restart_type == 1) fprintf(stderr, "%lld blocked restarts\n", blocked_restarts);
+	if (so.chrono_backtrack) fprintf(stderr, "%lld chronological backtracks, %lld lits implied again\n", chrono_backtracks, chrono_reimplied);
+	if (so.free_lazy_lits) fprintf(stderr, "%lld lazy lits freed, %lld reused\n", lazy_vars_freed, lazy_vars_reused);
+	fprintf(stderr, "%.2fMb clause arena, %lld compactions\n", ca.size() / 1048576.0, compactions);
 	if (so.ldsb) fprintf(stderr, "%.2f pushback time\n", pushback_time);
 }
 
 
+//-----
+// Phase methods
+
+// The levels below the current one were propagated without conflict; the
+// longest such trails give the target and best phases.
+void SAT::updatePhases() {
+	int assigned = 0;
+	for (int l = 0; l < trail.size()-1; l++) assigned += trail[l].size();
+	if (assigned > target_assigned) {
+		for (int l = 0; l < trail.size()-1; l++)
+			for (int i = 0; i < trail[l].size(); i++) target_phase[var(trail[l][i])] = sign(trail[l][i]);
+		target_assigned = assigned;
+	}
+	if (assigned > best_assigned) {
+		for (int l = 0; l < trail.size()-1; l++)
+			for (int i = 0; i < trail[l].size(); i++) best_phase[var(trail[l][i])] = sign(trail[l][i]);
+		best_assigned = assigned;
+	}
+}
+
+// A solution is the best phase from now on, until the next one.
+void SAT::saveSolutionPhases() {
+	int assigned = 0;
+	for (int l = 0; l < trail.size(); l++) {
+		for (int i = 0; i < trail[l].size(); i++) {
+			int v = var(trail[l][i]);
+			best_phase[v] = target_phase[v] = sign(trail[l][i]);
+			if (so.sol_phase) polarity[v] = sign(trail[l][i]);
+		}
+		assigned += trail[l].size();
+	}
+	target_assigned = assigned;
+	best_assigned = INT_MAX;
+}
+
+// Resets the saved phases, alternately to the best and the original ones,
+// and starts looking for a new target.
+void SAT::rephase() {
+	rephases++;
+	vec<char>& phase = (rephases & 1) && best_assigned > 0 ? best_phase : orig_phase;
+	for (int v = 0; v < nVars(); v++) {
+		if (phase[v] != 2) polarity[v] = phase[v];
+		target_phase[v] = 2;
+	}
+	target_assigned = 0;
+	next_rephase = engine.conflicts + so.rephase_base * (rephases + 1);
+}
+
 //-----
 // Branching methods
 
+struct VmtfStampLt {
+	const vec<long long int>& stamp;
+	bool operator() (int x, int y) const { return stamp[x] < stamp[y]; }
+	VmtfStampLt(const vec<long long int>& s) : stamp(s) {}
+};
+
+// Moves the vars bumped in this conflict to the back of the queue, keeping
+// their order.
+void SAT::vmtfBump() {
+	std::sort((int*) vmtf_bumped, (int*) vmtf_bumped + vmtf_bumped.size(), VmtfStampLt(vmtf_stamp));
+	for (int i = 0; i < vmtf_bumped.size(); i++) {
+		int x = vmtf_bumped[i];
+		if (x == vmtf_last) {
+			vmtf_stamp[x] = ++vmtf_stamps;
+			continue;
+		}
+		if (vmtf_search == x) vmtf_search = vmtf_prev[x];
+		if (vmtf_prev[x] >= 0) vmtf_next[vmtf_prev[x]] = vmtf_next[x];
+		vmtf_prev[vmtf_next[x]] = vmtf_prev[x];
+		vmtfEnqueue(x);
+		if (!assigns[x]) vmtf_search = x;
+	}
+	vmtf_bumped.clear();
+}
+
+// Like a lazy var which isn't created yet, a lit of an eager int var which
+// is channelled lazily isn't decided on until it is used
+inline bool SAT::canDecide(int x) {
+	return !assigns[x] && flags[x].decidable && !flags[x].lazy;
+}
+
 bool SAT::finished() {
 	assert(so.vsids);
+	if (so.sat_heuristic == 1) {
+		while (vmtf_search >= 0 && !canDecide(vmtf_search))
+			vmtf_search = vmtf_prev[vmtf_search];
+		return vmtf_search < 0;
+	}
 	while (!order_heap.empty()) {
 		int x = order_heap[0];
-		if (!assigns[x] && flags[x].decidable) return false;
+		if (canDecide(x)) return false;
 		order_heap.removeMin();
 	}
 	return true;
@@ -564,14 +1032,19 @@ bool SAT::finished() {
 DecInfo* SAT::branch() {
 	if (!so.vsids) return NULL;
 
-	assert(!order_heap.empty());
-
-	int next = order_heap.removeMin();
+	int next;
+	if (so.sat_heuristic == 1) {
+		// finished() has moved vmtf_search back to an unassigned var
+		next = vmtf_search;
+	} else {
+		assert(!order_heap.empty());
+		next = order_heap.removeMin();
+	}
 
 	assert(!assigns[next]);
 	assert(flags[next].decidable);
 
-	return new DecInfo(NULL, 2*next+polarity[next]);
+	return new DecInfo(NULL, 2*next+getPhase(next));
 }
 
 //-----
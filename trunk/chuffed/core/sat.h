@@ -7,10 +7,15 @@
 #include <chuffed/support/misc.h>
 #include <chuffed/support/heap.h>
 #include <chuffed/core/sat-types.h>
+#include <chuffed/core/clause-arena.h>
+#include <chuffed/core/options.h>
 #include <chuffed/branching/branching.h>
 
 #define TEMP_SC_LEN 1024
 #define MAX_SHARE_LEN 512
+#ifdef LOGGING
+#define BIN_IDENT_LIMIT (1u << 30)      // inline binary clause idents must fit in WatchElem::d1
+#endif
 
 class IntVar;
 class SClause;
@@ -36,12 +41,14 @@ public:
 
   vec<Clause*> clauses;             // List of problem clauses
   vec<Clause*> learnts;             // List of learnt clauses
+	ClauseArena ca;                   // Memory for the long clauses in clauses and learnts
 
 	vec<ChannelInfo> c_info;          // Channel info
   vec<vec<WatchElem> > watches;     // Watched lists
   vec<char> assigns;                // The current assignments
   vec<Reason> reason;               // explanation for the variable's current value, or 'NULL' if none
   vec<int> trailpos;                // the trailPos at which the assignment was made
+  vec<int> level;                   // the decision level at which the assignment was made
 	vec<LitFlags> flags;              // Info about literal
 
 	double pushback_time;
@@ -49,35 +56,80 @@ public:
 	// Lazy Lit Generation
 	int orig_cutoff;
 	vec<int> var_free_list;
-	vec<int> num_used;
+	vec<int> num_used;                // No. of learnt clauses each lazy var is in, from orig_cutoff on
+	vec<int> lazy_unused;             // Lazy vars which may have become unused, for collectLazyVars
 
 	vec<vec<Lit> > trail;             // Boolean vars fix order
 	vec<int> qhead;
 
 	vec<vec<Clause*> > rtrail;        // List of temporary reason clauses
 
+	// Chronological backtracking
+	vec<vec<Lit> > chrono_lits;       // Lits asserted above the level they are implied at, by level
+	vec<Lit> missed_lits;             // Those undone since, to be implied again if their reasons still are
+	vec<Reason> missed_reasons;
+
 	// Intermediate state
 	Clause *confl;
 	int index;
+	bool explaining;                  // In a lazy explain() from conflict analysis
 	vec<Lit> out_learnt;
   vec<char> seen;
 	vec<bool> ivseen;
 	vec<int> ivseen_toclear;
   vec<Lit> analyze_stack;
   vec<Lit> analyze_toclear;
+	vec<int> lbd_seen;                // Stamp of each decision level, for computing LBDs
+	vec<int> bound_lit;               // Position+1 in out_learnt of the bound lit kept per IntVar and direction
+	vec<int> bound_lit_toclear;
+	int lbd_stamp;
 	vec<IntVar*> min_vars;
 	SClause *temp_sc;
 
 	Clause *short_expl;
 	Clause *short_confl;
+#ifdef LOGGING
+	Clause *bin_confl;                     // conflicting inline binary clause, with its ident
+#endif
 
 	// VSIDS
 	double var_inc;                        // Amount to bump variable with.
+	double ivar_inc;                       // Amount to bump IntVar activity with.
 	double cla_inc;                        // Amount to bump clause with.
 	vec<double> activity;                  // A heuristic measurement of the activity of a variable.
 	Heap<VarOrderLt> order_heap;           // A priority queue of variables ordered with respect to the variable activity.
 	vec<bool> polarity;
 
+	// Phases, as signs of the lits to decide on (2 = none)
+	vec<char> orig_phase;                  // Polarity at the start of search, which rephasing may go back to
+	vec<char> target_phase;                // Longest conflict free trail since the last rephase
+	vec<char> best_phase;                  // Last solution, or longest conflict free trail before one
+	int target_assigned, best_assigned;    // How long those trails were
+	long long int next_rephase, rephases;
+
+	int getPhase(int v) const { return so.target_phase && target_phase[v] != 2 ? target_phase[v] : polarity[v]; }
+	void updatePhases();
+	void saveSolutionPhases();
+	void rephase();
+
+	// VMTF, a queue of vars in the order they were last bumped
+	vec<int> vmtf_prev, vmtf_next;
+	vec<long long int> vmtf_stamp;         // Position in the queue, increasing towards the back
+	int vmtf_last;
+	int vmtf_search;                       // Every var after this one in the queue is assigned
+	long long int vmtf_stamps;
+	vec<int> vmtf_bumped;                  // Vars bumped in the current conflict
+
+	// LRB, where the activity of a var is its learning rate
+	vec<long long int> lrb_assigned;       // Conflicts when it was assigned
+	vec<int> lrb_participated;             // Conflicts since then which it took part in
+	double lr_alpha;                       // Step size of learning rates, IntVar ones as well
+
+	void vmtfEnqueue(int x);
+	void vmtfBump();
+	void lrbAssign(int x);
+	void lrbUnassign(int x);
+
 	void insertVarOrder(int x);            // Insert a variable in the decision order priority queue.
 	void varDecayActivity();               // Decay all variables with the specified factor. Implemented by increasing the 'bump' value instead.
 	void varBumpActivity(Lit p);           // Increase a variable with the current 'bump' value.
@@ -85,9 +137,22 @@ public:
 	void learntLenDecayActivity();
 	void learntLenBumpActivity(int l);
 
+	// Glucose style restarts
+	double lbd_fast, lbd_slow;             // Moving averages of learnt clause LBDs, recent and long term
+	double trail_slow;                     // Moving average of the no. of assigned lits at conflicts
+	long long int restart_samples;         // Conflicts the averages are over
+	int restart_conflicts;                 // Conflicts since the last restart or blocked restart
+	int num_assigned;                      // No. of assigned vars, kept as they are set and unset
+
+	void updateRestartAvgs(int lbd);
+	bool restartDue() const;
+
 	// Statistics
 	int bin_clauses, tern_clauses, long_clauses, learnt_clauses;
-	long long int propagations, back_jumps, nrestarts, next_simp_db;
+	long long int propagations, back_jumps, nrestarts, next_simp_db, compactions;
+	long long int next_reduce_db, reductions, bound_lits_removed, blocked_restarts, chrono_backtracks, chrono_reimplied;
+	long long int lazy_vars_freed, lazy_vars_reused;
+	long long int tier_learnts[3], tier_promotions[3], tier_deletions[3];
   long long int clauses_literals, learnts_literals, max_literals, tot_literals;
 	double avg_depth;
 	double confl_rate;
@@ -107,10 +172,14 @@ public:
 	int  newVar(int n = 1, ChannelInfo ci = ci_null);
 	int  getLazyVar(ChannelInfo ci);
 	void removeLazyVar(int v);
+	void collectLazyVars();
 	void addClause(Lit p, Lit q);
 	void addClause(vec<Lit>& ps, bool one_watch = false);
 	void addClause(Clause& c, bool one_watch = false);
 	void removeClause(Clause& c);
+	void freeClause(Clause& c);
+	void checkGarbage();
+	void relocAll();
 	void topLevelCleanUp();
 	void simplifyDB();
 	bool simplify(Clause& c);
@@ -122,16 +191,22 @@ public:
 #endif
 	void cEnqueue(Lit p, Reason r);
 	void aEnqueue(Lit p, Reason r, int l);
-	void untrailToPos(vec<Lit>& t, int p);
+	void untrailToPos(vec<Lit>& t, int p, bool save_phase);
 	void btToLevel(int level);
 	void btToPos(int sat_pos, int core_pos);
+	void collectMissed(vec<Lit>& lits);
+	void reimplyMissed();
+	bool isMissedReason(Clause& c) const;
 	bool propagate();
 	Clause* getExpl(Lit p);
 	Clause* _getExpl(Lit p);
 	Clause* getConfl(Reason& r, Lit p);
 
 
-	void reduceDB();
+	template <class T> int computeLBD(T& ps);
+	int lbdTier(int lbd) const;
+	void updateLBD(Clause& c);
+	void reduceDB(bool forced = false);
 	void printStats();
 
 	// Branching methods
@@ -153,6 +228,10 @@ public:
 	void getLearntClause();
 	int findConflictLevel();
 	void explainUnlearnable();
+	unsigned int abstractLevel(int x) const;
+	void minimiseLearnt();
+	void strengthenBounds();
+	bool litRedundant(Lit p, unsigned int abstract_levels);
 	void clearSeen();
 	int  findBackTrackLevel();
 
@@ -167,14 +246,18 @@ public:
 	void    newDecisionLevel();
 	void    incVarUse(int v);
 	void    decVarUse(int v);
+	void    useLit(Lit p);
+	void    useLazyLit(Lit p);
+	bool    canDecide(int x);
 	void    setConfl(Lit p = lit_False, Lit q = lit_False);
+#ifdef LOGGING
+	void    setConfl(Lit p, Lit q, unsigned int ident);
+#endif
 
-	bool isRootLevel(int v) const { return trailpos[v] < engine.trail_lim[0]; }
-	bool isCurLevel(int v) const { return trailpos[v] >= engine.trail_lim.last(); }
-	int getLevel(int v) const { 
-		for (int i = engine.trail_lim.size(); i--; ) if (trailpos[v] >= engine.trail_lim[i]) return i;
-		return 0;
-	}
+	bool isRootLevel(int v) const { return level[v] == 0; }
+	bool rootFalse(int v) const;
+	bool isCurLevel(int v) const { return level[v] == decisionLevel(); }
+	int getLevel(int v) const { return level[v]; }
 
 	// Debug Methods
 
@@ -189,6 +272,7 @@ inline void SAT::newDecisionLevel() {
 	trail.push();
 	qhead.push(0);
 	rtrail.push();
+	chrono_lits.push();
 }
 
 inline void SAT::incVarUse(int v) {
@@ -197,8 +281,20 @@ inline void SAT::incVarUse(int v) {
 }
 
 inline void SAT::decVarUse(int v) {
-	v -= orig_cutoff;
-	if (v >= 0) num_used[v]--;
+	if (v - orig_cutoff >= 0 && --num_used[v - orig_cutoff] == 0 && so.free_lazy_lits) lazy_unused.push(v);
+}
+
+inline void SAT::insertVarOrder(int x) {
+	if (so.sat_heuristic == 1) {
+		if (vmtf_search < 0 || vmtf_stamp[x] > vmtf_stamp[vmtf_search]) vmtf_search = x;
+		return;
+	}
+	if (!order_heap.inHeap(x) && flags[x].decidable) order_heap.insert(x);
+}
+
+// Lits going into clauses must be kept in step with their int vars
+inline void SAT::useLit(Lit p) {
+	if (flags[var(p)].lazy) useLazyLit(p);
 }
 
 inline Clause* SAT::getExpl(Lit p) {
@@ -213,10 +309,12 @@ inline Clause* SAT::getExpl(Lit p) {
       return NULL;
 		default:
 			Clause& c = *short_expl;
-#ifdef LOGGING
-      assert(r.d.type = 2);
-#endif
+#ifndef LOGGING
 			c.sz = r.d.type; c[1] = toLit(r.d.d1); c[2] = toLit(r.d.d2);
+#else
+      assert(r.d.type == 2);
+      c.sz = 2; c[0] = p; c[1] = toLit(r.d.d1); c.ident = r.d.d2;
+#endif
 			return short_expl;
 	}
 }
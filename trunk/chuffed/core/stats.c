@@ -28,8 +28,13 @@ void Engine::printStats() {
 		fprintf(stderr, "%d vars (%d no lits, %d eager lits, %d lazy lits)\n", vars.size(), nl, el, ll);
 		fprintf(stderr, "%d propagators\n", propagators.size());
 		fprintf(stderr, "%lld conflicts\n", conflicts);
+		fprintf(stderr, "%lld restarts\n", restarts);
 		fprintf(stderr, "%lld nodes\n", nodes);
 		fprintf(stderr, "%lld propagations\n", propagations);
+		for (int i = 0; i < num_queues; i++) {
+			if (queue_props[i] == 0) continue;
+			fprintf(stderr, "%lld propagations at priority %d (%lld changed nothing)\n", queue_props[i], i, queue_idle[i]);
+		}
 		fprintf(stderr, "%lld solutions\n", solutions);
 		fprintf(stderr, "%.2f seconds init time\n", init_time);
 		if (opt_var) fprintf(stderr, "%.2f seconds opt time\n", opt_time);
@@ -49,6 +54,9 @@ void Engine::printStats() {
 		if (engine.opt_var != NULL) fprintf(stderr, "%d,", best_sol);
 		fprintf(stderr, "%d,%d,%d,%lld,%lld,%lld,%lld,%.2f,%.2f\n", vars.size(), sat.nVars(), propagators.size(), conflicts, sat.back_jumps, propagations, solutions, init_time, search_time);
 	}
+#ifdef LOGGING
+	logging::printStats();
+#endif
 }
 
 void Engine::checkMemoryUsage() {
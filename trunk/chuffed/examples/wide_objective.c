@@ -0,0 +1,86 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <chuffed/core/engine.h>
+#include <chuffed/core/propagator.h>
+#include <chuffed/branching/branching.h>
+#include <chuffed/vars/modelling.h>
+
+// Single machine weighted completion time. Long durations give start times
+// and an objective with very wide domains, so nearly all bound literals are
+// lazy and each improving solution creates new ones deep inside the domain.
+
+class WideObjective : public Problem {
+public:
+	// Constants
+
+	int n;                                          // number of jobs
+	int h;                                          // horizon
+	vec<int> dur;                                   // durations
+	vec<int> weight;                                // weights
+
+	// Core variables
+
+	vec<IntVar*> s;                                 // start times
+	vec<BoolView> b;                                // b[k] -> job i before job j
+	IntVar* obj;                                    // weighted sum of start times
+
+	WideObjective(int _n) : n(_n), h(0) {
+
+		srand(so.rnd_seed);
+		for (int i = 0; i < n; i++) {
+			dur.push(rand()%10000 + 1);
+			weight.push(rand()%10 + 1);
+			h += dur[i];
+		}
+
+		// Create vars
+
+		int wsum = 0;
+		for (int i = 0; i < n; i++) {
+			s.push(newIntVar(0, h - dur[i]));
+			wsum += weight[i];
+		}
+		obj = newIntVar(0, wsum * h);
+
+		// Post some constraints
+
+		for (int i = 0; i < n; i++) {
+			for (int j = i+1; j < n; j++) {
+				b.push(newBoolVar());
+				int_rel_half_reif(s[j], IRT_GE, s[i], b.last(), dur[i]);
+				int_rel_half_reif(s[i], IRT_GE, s[j], ~b.last(), dur[j]);
+			}
+		}
+		int_linear(weight, s, IRT_EQ, obj);
+
+		// Post some branchings
+
+		vec<Branching*> bb;
+		for (int k = 0; k < b.size(); k++) bb.push(new BoolView(b[k]));
+		branch(bb, VAR_INORDER, VAL_MAX);
+		branch(s, VAR_MIN_MIN, VAL_MIN);
+
+		optimize(obj, OPT_MIN);
+
+	}
+
+	// Function to print out solution
+
+	void print() {
+		int c = 0;
+		for (int i = 0; i < n; i++) c += weight[i] * dur[i];
+		printf("objective = %d\n", obj->getVal() + c);
+	}
+
+};
+
+int main(int argc, char** argv) {
+	parseOptions(argc, argv);
+
+	assert(argc == 2);
+
+	engine.solve(new WideObjective(atoi(argv[1])));
+
+	return 0;
+}
@@ -45,6 +45,8 @@ namespace FlatZinc {
 			if (s->id == "most_constrained") return VAR_SIZE_MIN;
 			if (s->id == "max_regret") return VAR_REGRET_MIN_MAX;
 			if (s->id == "random") return VAR_RANDOM;
+			if (s->id == "vmtf") return VAR_VMTF;
+			if (s->id == "lrb") return VAR_LRB;
 		}
 		std::cerr << "% Warning, ignored search annotation: ";
 		ann->print(std::cerr);
@@ -88,7 +90,13 @@ namespace FlatZinc {
 					for (unsigned int i = 0; i < sl->s.size(); i++) d.push(sl->s[i]);
 					sort((int*) d, (int*) d + d.size());
 					v = ::newIntVar(d[0], d.last());
+#ifdef LOGGING
+					// Holes in an IntVarEL domain must have literals by the time it is
+					// created; a sparse var needs none.
+					v->specialiseToSL(d);
+#else
 					if (!v->allowSet(d)) TL_FAIL();
+#endif
 				}
 			} else {
 				v = ::newIntVar();
@@ -153,6 +161,9 @@ namespace FlatZinc {
   }
 
 	void FlatZincSpace::postConstraint(const ConExpr& ce, AST::Node* ann) {
+#ifdef LOGGING
+		logging::name_origin(logging::active_item, ce.id);
+#endif
 		try {
 			registry().post(ce, ann);
 		} catch (AST::TypeError& e) {
@@ -17,6 +17,9 @@ int main(int argc, char** argv) {
 -verbosity=n
 -print_sol=true|false
 -restart_base=n
+-restart_type=0|1
+-restart_margin=n
+-restart_block=n
 "
 -toggle_vsids=true|false
 -branch_random=true|false
@@ -32,19 +35,32 @@ int main(int argc, char** argv) {
 "
 -sat_simplify=true|false
 -fd_simplify=true|false
+-free_lazy_lits=true|false
 "
 -lazy=true|false
 -finesse=true|false
 -learn=true|false
 -vsids=true|false
+-sat_heuristic=0|1|2
 -phase_saving=0|1|2
+-target_phase=true|false
+-sol_phase=true|false
+-rephase_base=n
 -sort_learnt_level=true|false
 -one_watch=true|false
+-learnt_minimise=true|false
+-strengthen_bounds=true|false
+-chrono_backtrack=n
 "
 -eager_limit=n
+-lazy_channel=true|false
 -sat_var_limit=n
 -nof_learnts=n
 -learnts_mlimit=n
+-lbd_core=n
+-lbd_tier2=n
+-reduce_base=n
+-reduce_inc=n
 "
 -lang_ext_linear=true|false
 "
@@ -69,6 +85,20 @@ int main(int argc, char** argv) {
 -alldiff_cheat=true|false
 -alldiff_stage=true|false
 "
+-logging=true|false
+-log_solution=true|false
+-litfile=file
+-logfile=file
+-log_binary=true|false
+-log_async=true|false
+-log_buffer=<n>
+-log_compress=<n>
+-log_trim=true|false
+-log_expl_cache=<n>
+-log_stats=true|false
+-log_stats_csv=file
+-log_check=true|false
+"
 -a|--all|--all-solutions
 --free
 --parallel
@@ -90,6 +120,7 @@ int main(int argc, char** argv) {
 
 #ifdef LOGGING
   logging::finalize();
+  if (!logging::check_ok()) return 2;
 #endif
 #if 0
 	return 0;
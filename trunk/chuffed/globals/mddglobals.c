@@ -42,6 +42,9 @@ static void addMDDProp(vec<IntVar*>& x, MDDTable& tab, _MDD m, const MDDOpts& mo
    vec<int> doms;
    vec< IntView<> > w;
 
+   // Explaining can create lits, see IntVarEL::setImplied
+   if (so.lazy_channel) ERROR("MDD propagators are not supported with -lazy_channel\n");
+
    vec<intpair> bounds;
    for (int i = 0; i < x.size(); i++)
    {
@@ -28,7 +28,7 @@ public:
 			if (sat.value(ps[i]) != l_False) return NULL;
 		}
 		ps[0] = getSymLit((*r)[0], r1, r2);
-		return Clause_new(ps, true);
+		return so.learn && ps.size() >= 2 ? sat.ca.alloc(ps, true) : Clause_new(ps, true);
 	}
 
 };
@@ -0,0 +1 @@
+[lit_True = 1, x0 = 0, x1 = 1, x2 = 4, x3 = 9, x4 = 15, x5 = 22, x6 = 32, x7 = 34, d0_1 = 1, d0_2 = 4, d0_3 = 9, d0_4 = 15, d0_5 = 22, d0_6 = 32, d0_7 = 34, d1_2 = 3, d1_3 = 8, d1_4 = 14, d1_5 = 21, d1_6 = 31, d1_7 = 33, d2_3 = 5, d2_4 = 11, d2_5 = 18, d2_6 = 28, d2_7 = 30, d3_4 = 6, d3_5 = 13, d3_6 = 23, d3_7 = 25, d4_5 = 7, d4_6 = 17, d4_7 = 19, d5_6 = 10, d5_7 = 12, d6_7 = 2]
\ No newline at end of file
@@ -156,7 +156,7 @@ public:
             ps[k] = get_val_lit(expl[k]);
           ps[0] = p;
 
-          Clause* c = Clause_new(ps, true);
+          Clause* c = sat.ca.alloc(ps, true);
           c->learnt = true;
 				  sat.addClause(*c);
           return c;
@@ -1539,7 +1539,7 @@ Clause* WMDDProp::explain(Lit p, int inf)
   if(opts.expl_strat == MDDOpts::E_KEEP)
   {
     expln[0] = p;
-    Clause* c = Clause_new(expln, true);
+    Clause* c = sat.ca.alloc(expln, true);
     c->learnt = true;
     sat.addClause(*c);
     return c;
@@ -1645,7 +1645,7 @@ Clause* WMDDProp::incExplain(Lit p, int var, int val)
   if(opts.expl_strat == MDDOpts::E_KEEP)
   {
     expln[0] = p;
-    Clause* c = Clause_new(expln, true);
+    Clause* c = sat.ca.alloc(expln, true);
     c->learnt = true;
     sat.addClause(*c);
     return c;  
@@ -1890,6 +1890,9 @@ void WMDDProp::debugStateDot(void)
 //          Or, indeed, that there aren't any repetitions or inversions in variable order.
 WMDDProp* evgraph_to_wmdd(vec<IntVar*> _vs, IntVar* _cost, EVLayerGraph& g, EVLayerGraph::NodeID rootID, const MDDOpts& opts)
 {
+  // Explaining can create lits, see IntVarEL::setImplied
+  if (so.lazy_channel) ERROR("WMDD propagators are not supported with -lazy_channel\n");
+
   int nNodes = g.traverse(rootID);
   
   // Level for each node.
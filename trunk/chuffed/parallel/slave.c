@@ -305,7 +305,7 @@ void SAT::addLearnt() {
 
 	assert(value(c[0]) == l_True || (value(c[0]) != l_False && value(c[1]) != l_False) || enqueue_first);
 
-	Clause *r = Clause_new(c, true);
+	Clause *r = ca.alloc(c, true);
 	r->activity()  = cla_inc;
 
 	addClause(*r, so.one_watch);
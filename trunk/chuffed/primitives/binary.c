@@ -21,7 +21,8 @@ public:
 	}
 
 	void wakeup(int i, int c) {
-		if (!R || !r.isFalse()) pushInQueue();
+		if (R && r.isFalse()) satisfied = true;
+		else pushInQueue();
 	}
 
 	bool propagate() {
@@ -75,7 +76,8 @@ public:
 	}
 
 	void wakeup(int i, int c) {
-		if (!R || !r.isFalse()) pushInQueue();
+		if (R && r.isFalse()) satisfied = true;
+		else pushInQueue();
 	}
 
 	bool propagate() {
@@ -32,35 +32,12 @@ void array_int_element(IntVar* _x, vec<int>& a, IntVar* _y, int offset) {
 
 	vec<int> z;
 	for (int i = _x->getMin()-offset; i <= _x->getMax()-offset; i++) {
-#ifndef LOGGING
 		if (!_x->indomain(i+offset)) continue;
 		if (!_y->indomain(a[i])) continue;
-#endif
 		z.push(a[i]);
 	}
 
-#ifndef LOGGING
 	_y->specialiseToSL(z);
-#else
-	_y->specialiseToEL();
-  std::sort((int*) z, (int*) z + z.size());
-  TL_SET(_y, setMin, z[0]);
-  TL_SET(_y, setMax, z.last());
-  /*
-  if(_y->setMinNotR(z[0]))
-    _y->setMin(z[0]);
-  if(_y->setMaxNotR(z.last()))
-    _y->setMax(z.last());
-    */
-  for(int vi = 1; vi < z.size(); vi++) {
-    for(int k = z[vi-1]+1; k < z[vi]-1; k++)
-      /*
-      if(_y->remValNotR(k))
-        _y->remVal(k);
-        */
-      TL_SET(_y, remVal, k);
-  }
-#endif
 
 	_x->specialiseToEL();
 
@@ -5,14 +5,33 @@ FZN2CMOD=${CCP_BASE}/fzn2cmod/fzn2cmod
 FDRES_SIMP=${CCP_BASE}/fdres/fdres-simp
 FDRES_CHECK=${CCP_BASE}/fdres/fdres-check
 CCP_STREAM=${CCP_BASE}/checker/certcp_stream
+DRES_CONVERT=./dres_convert
 TEMPFILE=tempfile
 
+## Set LOG_BINARY=true to have chuffed write a binary trace, which is
+## converted back to text before checking.
+LOG_BINARY=${LOG_BINARY:-false}
+## Set LOG_COMPRESS to a gzip level (1-9) to have the trace and literal
+## files compressed; they are decompressed through a pipe for checking.
+LOG_COMPRESS=${LOG_COMPRESS:-0}
+## Set LOG_CHECK=true to have chuffed check the resolution steps while it
+## solves, so a broken trace is rejected before the external checkers run.
+LOG_CHECK=${LOG_CHECK:-false}
+## Set DESPARSE=true to widen sparse domains into intervals before solving,
+## for checkers which cannot read sparse domains.
+DESPARSE=${DESPARSE:-false}
+
 ## Build model
 fzn_model=`${TEMPFILE} --suffix=.fzn`
 ccp_model=`${TEMPFILE} --suffix=.fzn`
 chuffed_out=`${TEMPFILE}`
 
-${MZN2FZN} -G chuffed-cert -o >(./desparse_fzn.py > ${fzn_model}) $@
+if [ "${DESPARSE}" = "true" ]
+then
+  ${MZN2FZN} -G chuffed-cert -o >(./desparse_fzn.py > ${fzn_model}) $@
+else
+  ${MZN2FZN} -G chuffed-cert -o ${fzn_model} $@
+fi
 
 ${FZN2CMOD} ${fzn_model} > ${ccp_model}
 if [ $? -ne 0 ]
@@ -20,7 +39,13 @@ then
   exit 1
 fi
 
-./fzn_chuffed -S -f -logging=true ${fzn_model} | tee ${chuffed_out}
+./fzn_chuffed -S -f -logging=true -log_binary=${LOG_BINARY} -log_compress=${LOG_COMPRESS} -log_check=${LOG_CHECK} ${fzn_model} | tee ${chuffed_out}
+
+## fzn_chuffed exits with 2 if its own proof check failed
+if [ ${PIPESTATUS[0]} -eq 2 ]
+then
+  exit 1
+fi
 
 ## Figure out what mode we're running in.
 ## ==============
@@ -37,7 +62,15 @@ fi
 grep -q -e "=======" ${chuffed_out}
 if [ $? -eq 0 ]
 then
-  ${FDRES_SIMP} log.lit log.dres > log.fdres
+  if [ "${LOG_COMPRESS}" != "0" ]
+  then
+    ${FDRES_SIMP} <(${DRES_CONVERT} log.lit.gz) <(${DRES_CONVERT} log.dres.gz) > log.fdres
+  elif [ "${LOG_BINARY}" = "true" ]
+  then
+    ${FDRES_SIMP} log.lit <(${DRES_CONVERT} log.dres) > log.fdres
+  else
+    ${FDRES_SIMP} log.lit log.dres > log.fdres
+  fi
   echo -n "Checking FD resolution trace... "
   ${FDRES_CHECK} log.fdres
   if [ $? -ne 0 ]
@@ -79,4 +112,4 @@ fi
 rm ${fzn_model}
 rm ${ccp_model}
 rm ${chuffed_out}
-rm -f log.{sol,lit,dres,fdres}
+rm -f log.{sol,lit,dres,fdres} log.{lit,dres}.gz
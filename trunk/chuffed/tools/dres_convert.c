@@ -0,0 +1,82 @@
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <chuffed/core/log-format.h>
+
+// Converts a binary proof trace (written with -log_binary=true) back into
+// the textual .dres format read by fdres-simp and fdres-check.  The input
+// may also be gzipped (-log_compress); gzipped text traces and literal files
+// are just decompressed, so the checker can read them through a pipe.
+//
+// usage: dres_convert [in.dres[.gz] [out.dres]]
+
+using namespace logging;
+
+static void corrupt(const char* what) {
+	fprintf(stderr, "dres_convert: corrupt trace (%s)\n", what);
+	exit(1);
+}
+
+static unsigned int get(gzFile in, const char* what) {
+	unsigned int x;
+	if (!read_varint(in, x)) corrupt(what);
+	return x;
+}
+
+int main(int argc, char** argv) {
+	if (argc > 3 || (argc > 1 && strcmp(argv[1], "-h") == 0)) {
+		fprintf(stderr, "usage: %s [in.dres[.gz] [out.dres]]\n", argv[0]);
+		return 1;
+	}
+	gzFile in = argc > 1 ? gzopen(argv[1], "rb") : gzdopen(fileno(stdin), "rb");
+	if (!in) { perror(argc > 1 ? argv[1] : "stdin"); return 1; }
+	FILE* out = argc > 2 ? fopen(argv[2], "w") : stdout;
+	if (!out) { perror(argv[2]); return 1; }
+
+	char magic[sizeof(log_magic)];
+	int n = gzread(in, magic, sizeof(magic));
+	if (n != sizeof(magic) || memcmp(magic, log_magic, sizeof(magic)) != 0) {
+		// Already text
+		char buf[1<<16];
+		if (n > 0) fwrite(magic, 1, n, out);
+		while ((n = gzread(in, buf, sizeof(buf))) > 0) fwrite(buf, 1, n, out);
+		gzclose(in);
+		if (out != stdout) fclose(out);
+		return n < 0;
+	}
+
+	unsigned int ident = 0;
+	int tag;
+	while ((tag = gzgetc(in)) != -1) {
+		switch (tag) {
+			case LOG_HINT: {
+				unsigned int hint = get(in, "hint");
+				if (hint) fprintf(out, "c c%u\n", hint);
+				else fprintf(out, "c -\n");
+				break;
+			}
+			case LOG_DELETE:
+				fprintf(out, "d %u\n", ident + 1 - get(in, "deletion"));
+				break;
+			case LOG_ADD:
+			case LOG_RESOLVE: {
+				ident += get(in, "ident");
+				fprintf(out, "%u ", ident);
+				unsigned int x;
+				while ((x = get(in, "literal"))) fprintf(out, "%d ", decode_lit(x));
+				fprintf(out, "0 ");
+				if (tag == LOG_RESOLVE) {
+					while ((x = get(in, "antecedent"))) fprintf(out, "%u ", ident - x);
+				}
+				fprintf(out, "0\n");
+				break;
+			}
+			default:
+				corrupt("unknown record");
+		}
+	}
+
+	gzclose(in);
+	if (out != stdout) fclose(out);
+	return 0;
+}
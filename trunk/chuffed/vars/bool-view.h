@@ -43,7 +43,7 @@ public:
 
 	bool finished() { return isFixed(); }
 	double getScore(VarBranch vb) { NOT_SUPPORTED; }
-	DecInfo* branch() { return new DecInfo(NULL, 2*v+(sat.polarity[v])); }
+	DecInfo* branch() { return new DecInfo(NULL, 2*v+sat.getPhase(v)); }
 
 	// Change domains:
 
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cstring>
 #include <chuffed/vars/int-var.h>
 #include <chuffed/core/sat.h>
 
@@ -50,6 +51,7 @@ void IntVarEL::initVLits() {
     sat.cEnqueue(getEQLit(min), NULL);
   }
 #endif
+	if (so.lazy_channel && !isFixed()) setLazy(min, max, base_vlit/2);
 }
 
 void IntVarEL::initBLits() {
@@ -74,6 +76,72 @@ void IntVarEL::initBLits() {
     sat.flags[var(getLELit(i))].no_log = true;
 #endif
   }
+	if (so.lazy_channel) setLazy(min+1, max, (base_blit-1)/2);
+}
+
+// Lazy channelling: the lits in [i0, i1] are left alone by the channel
+// functions until useLit is called on them
+void IntVarEL::setLazy(int i0, int i1, int base) {
+	for (int i = i0; i <= i1; i++) {
+		if (sat.value(Lit(base+i, 0)) == l_Undef) sat.flags[base+i].lazy = true;
+	}
+}
+
+// Keeps p in step with the domain from now on, setting it now if the
+// domain already implies it, and lets it be decided on
+Lit IntVarEL::useLit(Lit p) {
+	int x = var(p);
+	if (!sat.flags[x].lazy) return p;
+	sat.flags[x].lazy = false;
+	setImplied(x);
+	sat.insertVarOrder(x);
+	bool blit = sat.c_info[x].val_type;
+	int i = sat.c_info[x].val + blit;
+	vec<int>& used = blit ? used_blits : used_vlits;
+	int k = std::lower_bound((int*) used, (int*) used + used.size(), i) - (int*) used;
+	used.push();
+	memmove((int*) used + k + 1, (int*) used + k, (used.size()-k-1) * sizeof(int));
+	used[k] = i;
+	return p;
+}
+
+// Sets the unset lazy lit x if the domain implies it, at the level of the
+// bound lit which implies it
+bool IntVarEL::setImplied(int x) {
+	if (sat.value(Lit(x, 0)) != l_Undef) return false;
+	bool blit = sat.c_info[x].val_type;
+	int i = sat.c_info[x].val + blit;         // [x >= i] or [x = i]
+	Lit p, q;
+	if (min >= i+!blit) { p = blit ? getGELit(i) : getNELit(i); q = minBoundLit(i+!blit); }
+	else if (max < i) { p = blit ? getLELit(i-1) : getNELit(i); q = maxBoundLit(i-1); }
+	else return false;
+	Clause* r = (Clause*) malloc(sizeof(Clause) + 2 * sizeof(Lit));
+	r->clearFlags(); r->temp_expl = 1; r->sz = 2; (*r)[1] = ~q;
+#ifdef LOGGING
+	r->origin = 0; r->ident = 0;
+#endif
+	int l = sat.getLevel(var(q));
+	// While a lazy explanation is made in conflict analysis, the current
+	// level's trail is being scanned, and a lit pushed on it now is missed
+	assert(!sat.explaining || l < sat.decisionLevel());
+	sat.rtrail[l].push(r);
+	sat.aEnqueue(p, r, l);
+	return true;
+}
+
+// Every bound lit which is set is used, so the used [x >= j] with the
+// least j >= v, given v <= min, is the one which was set first
+inline Lit IntVarEL::minBoundLit(int v) {
+	int *u = std::lower_bound((int*) used_blits, (int*) used_blits + used_blits.size(), v);
+	assert(sat.value(getGELit(*u)) == l_True);
+	return getGELit(*u);
+}
+
+// Likewise the used [x <= j] with the greatest j <= v, given v >= max
+inline Lit IntVarEL::maxBoundLit(int v) {
+	int *u = std::upper_bound((int*) used_blits, (int*) used_blits + used_blits.size(), v+1) - 1;
+	assert(sat.value(getLELit(*u-1)) == l_True);
+	return getLELit(*u-1);
 }
 
 void IntVarEL::setVLearnable() {
@@ -107,10 +175,10 @@ Lit IntVarEL::getLit(int64_t v, int t) {
 	if (v < lit_min) return toLit(1^(t&1));              // 1, 0, 1, 0
 	if (v > lit_max) return toLit(((t-1)>>1)&1);     // 1, 0, 0, 1
 	switch (t) {
-		case 0: return getNELit(v);
-		case 1: return getEQLit(v);
-		case 2: return getGELit(v);
-		case 3: return getLELit(v);
+		case 0: return useLit(getNELit(v));
+		case 1: return useLit(getEQLit(v));
+		case 2: return useLit(getGELit(v));
+		case 3: return useLit(getLELit(v));
 		default: NEVER;
 	}
 }
@@ -120,6 +188,15 @@ inline void IntVarEL::channelMin(int v) {
 	// Set [x >= v-1] to [x >= min+1] using [x >= i] \/ ![x >= v]
 	// Set [x != v-1] to [x != min] using [x != i] \/ ![x >= v]
 	Reason r(mk_reason(~getGELit(v)));
+	if (so.lazy_channel) {
+		int *b = used_blits, *e = used_blits + used_blits.size();
+		for (int *u = std::lower_bound(b, e, v); u-- > b && *u > min; ) sat.cEnqueue(getGELit(*u), r);
+		b = used_vlits; e = used_vlits + used_vlits.size();
+		for (int *u = std::lower_bound(b, e, v); u-- > b && *u >= min; ) {
+			if (vals[*u]) sat.cEnqueue(getNELit(*u), r);
+		}
+		return;
+	}
 	for (int i = v-1; i > min; i--) {
 		sat.cEnqueue(getGELit(i), r);
 		if (vals[i]) sat.cEnqueue(getNELit(i), r);
@@ -133,6 +210,15 @@ inline void IntVarEL::channelMax(int v) {
 	// Set [x <= v+1] to [x <= max-1] to using [x <= i] \/ ![x <= v]
 	// Set [x != v+1] to [x != max] to using ![x = i] \/ ![x <= v]
 	Reason r(mk_reason(~getLELit(v)));
+	if (so.lazy_channel) {
+		int *b = used_blits, *e = used_blits + used_blits.size();
+		for (int *u = std::upper_bound(b, e, v+1); u < e && *u <= max; u++) sat.cEnqueue(getLELit(*u-1), r);
+		b = used_vlits; e = used_vlits + used_vlits.size();
+		for (int *u = std::upper_bound(b, e, v); u < e && *u <= max; u++) {
+			if (vals[*u]) sat.cEnqueue(getNELit(*u), r);
+		}
+		return;
+	}
 	for (int i = v+1; i < max; i++) {
 		sat.cEnqueue(getLELit(i), r);
 		if (vals[i]) sat.cEnqueue(getNELit(i), r);
@@ -146,12 +232,12 @@ inline void IntVarEL::channelFix(int v) {
 	Reason r(mk_reason(getNELit(v)));
 	if (min < v) {
 		// Set [x >= v] using [x >= v] \/ ![x = v]
-		sat.cEnqueue(getGELit(v), r);
+		sat.cEnqueue(useLit(getGELit(v)), r);
 		channelMin(v);
 	}
 	if (max > v) {
 		// Set [x <= v] using [x <= v] \/ ![x = v]
-		sat.cEnqueue(getLELit(v), r);
+		sat.cEnqueue(useLit(getLELit(v)), r);
 		channelMax(v);
 	}
 }
@@ -161,7 +247,7 @@ inline void IntVarEL::updateMin(int v, int i) {
 	for (; v < i; ++v) {
 		// Set [x >= v+1] using [x >= v+1] \/ [x <= v-1] \/ [x = v]
 		Reason r(mk_reason(getLELit(v-1), getEQLit(v)));
-		sat.cEnqueue(getGELit(v+1), r);
+		sat.cEnqueue(useLit(getGELit(v+1)), r);
 	}
 	min = v; changes |= EVENT_C | EVENT_L;
 }
@@ -170,7 +256,7 @@ inline void IntVarEL::updateMax(int v, int i) {
 	for (; v > i; --v) {
 		// Set [x <= v-1] using [x <= v-1] \/ [x >= v+1] \/ [x = v]
 		Reason r(mk_reason(getGELit(v+1), getEQLit(v)));
-		sat.cEnqueue(getLELit(v-1), r);
+		sat.cEnqueue(useLit(getLELit(v-1)), r);
 	}
 	max = v; changes |= EVENT_C | EVENT_U;
 }
@@ -180,7 +266,7 @@ inline void IntVarEL::updateMin() {
 	while (!vals[v]) {
 		// Set [x >= v+1] using [x >= v+1] \/ [x <= v-1] \/ [x = v]
 		Reason r(mk_reason(getLELit(v-1), getEQLit(v)));
-		sat.cEnqueue(getGELit(v+1), r);
+		sat.cEnqueue(useLit(getGELit(v+1)), r);
 		v++;
 	}
 	if (v > min) { min = v; changes |= EVENT_L; }
@@ -191,7 +277,7 @@ inline void IntVarEL::updateMax() {
 	while (!vals[v]) {
 		// Set [x <= v-1] using [x <= v-1] \/ [x >= v+1] \/ [x = v]
 		Reason r(mk_reason(getGELit(v+1), getEQLit(v)));
-		sat.cEnqueue(getLELit(v-1), r);
+		sat.cEnqueue(useLit(getLELit(v-1)), r);
 		v--;
 	}
 	if (v < max) { max = v; changes |= EVENT_U; }
@@ -328,7 +414,7 @@ Lit IntVarEL::createSetLit(vec<Lit>& head) {
 			}
 			holes.push(v);
 		} else {
-			return getNELit(v);
+			return useLit(getNELit(v));
 		}
 	}
 
@@ -345,10 +431,10 @@ Lit IntVarEL::createSetLit(vec<Lit>& head) {
 	// Check cases where an original lit is sufficient
 
 	if (lower_bound == lit_min && holes.size() == 0) {
-		return getGELit(upper_bound+1);
+		return useLit(getGELit(upper_bound+1));
 	}
 	if (upper_bound == lit_max && holes.size() == 0) {
-		return getLELit(lower_bound-1);
+		return useLit(getLELit(lower_bound-1));
 	}
 
 	// Create new lit that complements failure set
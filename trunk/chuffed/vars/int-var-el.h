@@ -9,6 +9,10 @@ class IntVarEL : public IntVar {
 	int base_vlit;
 	int base_blit;
 
+	// With lazy_channel, the vals of the bound and value lits which are used
+	vec<int> used_blits;
+	vec<int> used_vlits;
+
 	Lit getNELit(int v) const { return toLit(base_vlit+2*v); }
 	Lit getEQLit(int v) const { return toLit(base_vlit+2*v+1); }
 	Lit getGELit(int v) const { return toLit(base_blit+2*v); }
@@ -17,6 +21,10 @@ class IntVarEL : public IntVar {
 	void channelMin(int v);
 	void channelMax(int v);
 	void channelFix(int v);
+	void setLazy(int i0, int i1, int base);
+	bool setImplied(int x);
+	Lit minBoundLit(int v);
+	Lit maxBoundLit(int v);
 
 #if INT_DOMAIN_LIST
 	void updateMin(int v, int i);
@@ -48,6 +56,7 @@ public:
 
 	// t = 0: [x != v], t = 1: [x = v], t = 2: [x >= v], t = 3: [x <= v]
 	Lit getLit(int64_t v, int t);
+	Lit useLit(Lit p);
 
 	Lit getMinLit() const { return ~getGELit(min); }
 	Lit getMaxLit() const { return ~getLELit(max); }
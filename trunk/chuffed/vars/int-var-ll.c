@@ -1,3 +1,4 @@
+#include <cstring>
 #include <chuffed/vars/int-var.h>
 #include <chuffed/core/sat.h>
 #include <chuffed/core/propagator.h>
@@ -7,6 +8,7 @@
 IntVarLL::IntVarLL(const IntVar& other) : IntVar(other), ld(2), li(0), hi(1) {
 	ld[0].var = 0; ld[0].val = min-1; ld[0].prev = -1; ld[0].next = 1;
 	ld[1].var = 1; ld[1].val = max; ld[1].prev = 0; ld[1].next = -1;
+	order.push(0); order.push(1);
 	valLit = Lit(sat.nVars(), 1);
 	int v = sat.newVar(1, ChannelInfo(var_id, 1, 0, 0));
 	sat.flags[v].setDecidable(false);
@@ -16,6 +18,11 @@ IntVarLL::IntVarLL(const IntVar& other) : IntVar(other), ld(2), li(0), hi(1) {
 }
 
 DecInfo* IntVarLL::branch() {
+	// Bound decisions only; x <= sol_val, then x >= sol_val
+	if (so.sol_phase && min <= sol_val && sol_val <= max) {
+		if (sol_val < max) return new DecInfo(this, sol_val, 3);
+		return new DecInfo(this, sol_val-1, 2);
+	}
 	switch (preferred_val) {
 		case PV_MIN: return new DecInfo(this, min, 3);
 		case PV_MAX: return new DecInfo(this, max-1, 2);
@@ -35,64 +42,89 @@ inline int IntVarLL::getLitNode() {
 	return i;
 }
 
+// The lit is unassigned, so it lies strictly between the bounds
 void IntVarLL::freeLazyVar(int val) {
-	int ni;
-	if (val < min) {
-		ni = li;
-		while (ld[ni].val > val) { ni = ld[ni].prev; assert(0 <= ni && ni < ld.size()); }
-	} else if (val >= max) {
-		ni = hi;
-		while (ld[ni].val < val) { ni = ld[ni].next; assert(0 <= ni && ni < ld.size()); }
-	} else NEVER;
+	assert(ld[li].val < val && val < ld[hi].val);
+	int pos = findPos(val);
+	int ni = order[pos];
 	assert(ld[ni].val == val);
 	ld[ld[ni].prev].next = ld[ni].next;
 	ld[ld[ni].next].prev = ld[ni].prev;
+	memmove((int*) order + pos, (int*) order + pos + 1, (order.size()-pos-1) * sizeof(int));
+	order.pop();
 	freelist.push(ni);
 }
 
+// Position in order of the first node with val >= v.  The last node has
+// val >= max0, so there always is one.
+inline int IntVarLL::findPos(int v) const {
+	int lo = 0, up = order.size()-1;
+	while (lo < up) {
+		int mid = (lo+up) / 2;
+		if (ld[order[mid]].val < v) lo = mid+1;
+		else up = mid;
+	}
+	return lo;
+}
+
+// Makes a node and lazy var for [x <= v] at pos in order, which is between
+// the nodes at pos-1 and pos in the list.  v must lie strictly between
+// their vals, so it can't be beyond the sentinels at min0-1 and max0.
+inline int IntVarLL::newLitNode(int v, int pos) {
+	assert(pos > 0 && ld[order[pos-1]].val < v && v < ld[order[pos]].val);
+	int mi = getLitNode();
+	ld[mi].var = sat.getLazyVar(ChannelInfo(var_id, 1, 1, v));
+	ld[mi].val = v;
+	ld[mi].prev = order[pos-1];
+	ld[mi].next = order[pos];
+	ld[ld[mi].prev].next = mi;
+	ld[ld[mi].next].prev = mi;
+	order.push();
+	memmove((int*) order + pos + 1, (int*) order + pos, (order.size()-pos-1) * sizeof(int));
+	order[pos] = mi;
+	return mi;
+}
+
+// Bound lits are mostly wanted close to the current bound, so a few nodes
+// are walked from there before looking in order.
+
 inline Lit IntVarLL::getGELit(int v) {
 	if (v > max) return getMaxLit(); 
 	assert(v >= min);
 	int ni = li;
-	while (ld[ni].val < v-1) { ni = ld[ni].next; assert(0 <= ni && ni < ld.size()); }
+	for (int k = 0; k < ll_walk && ld[ni].val < v-1; k++) ni = ld[ni].next;
 	if (ld[ni].val == v-1) return Lit(ld[ni].var, 1);
-	// overshot, create new var and insert before ni
-	int mi = getLitNode();
-	ld[mi].var = sat.getLazyVar(ChannelInfo(var_id, 1, 1, v-1));
-	ld[mi].val = v-1;
-	ld[mi].next = ni;
-	ld[mi].prev = ld[ni].prev;
-	ld[ni].prev = mi;
-	ld[ld[mi].prev].next = mi;
-	return Lit(ld[mi].var, 1);
+	int pos = findPos(v-1);
+	ni = order[pos];
+	if (ld[ni].val != v-1) ni = newLitNode(v-1, pos);
+	return Lit(ld[ni].var, 1);
 }
 
 inline Lit IntVarLL::getLELit(int v) {
 	if (v < min) return getMinLit(); 
 	assert(v <= max);
 	int ni = hi;
-	while (ld[ni].val > v) { ni = ld[ni].prev; assert(0 <= ni && ni < ld.size()); }
+	for (int k = 0; k < ll_walk && ld[ni].val > v; k++) ni = ld[ni].prev;
 	if (ld[ni].val == v) return Lit(ld[ni].var, 0);
-	// overshot, create new var and insert before ni
-	int mi = getLitNode();
-	ld[mi].var = sat.getLazyVar(ChannelInfo(var_id, 1, 1, v));
-	ld[mi].val = v;
-	ld[mi].prev = ni;
-	ld[mi].next = ld[ni].next;
-	ld[ni].next = mi;
-	ld[ld[mi].next].prev = mi;
-	return Lit(ld[mi].var, 0);
+	int pos = findPos(v);
+	ni = order[pos];
+	if (ld[ni].val != v) ni = newLitNode(v, pos);
+	return Lit(ld[ni].var, 0);
 }
 
+// The caller may keep the lit, so it is never freed
 Lit IntVarLL::getLit(int64_t v, int t) {
 	assert(engine.decisionLevel() == 0);
 	if (v < min) return toLit(1^(t&1));       // _, _, 1, 0
 	if (v > max) return toLit(t&1);           // _, _, 0, 1
+	Lit p;
 	switch (t) {
-		case 2: return getGELit(v);
-		case 3: return getLELit(v);
+		case 2: p = getGELit(v); break;
+		case 3: p = getLELit(v); break;
 		default: NEVER;
 	}
+	sat.incVarUse(var(p));
+	return p;
 }
 
 // Use when you've just set [x >= v]
@@ -163,20 +195,17 @@ bool IntVarLL::remVal(int64_t v, Reason r, bool channel) {
 	return true;
 }
 
+// As with getLit, the lit is never freed
 Lit IntVarLL::createLit(int _v) {
 	int v = _v >> 2;
 	int s = 1 - _v%2;
-	int ni = 1;
-	while (ld[ni].val > v) { ni = ld[ni].prev; assert(0 <= ni && ni < ld.size()); }
-	if (ld[ni].val == v) return Lit(ld[ni].var, s);
-	// overshot, create new var and insert before ni
-	int mi = getLitNode();
-	ld[mi].var = sat.getLazyVar(ChannelInfo(var_id, 1, 1, v));
-	ld[mi].val = v;
-	ld[mi].prev = ni;
-	ld[mi].next = ld[ni].next;
-	ld[ni].next = mi;
-	ld[ld[mi].next].prev = mi;
+	int pos = findPos(v);
+	int ni = order[pos];
+	if (ld[ni].val == v) {
+		sat.incVarUse(ld[ni].var);
+		return Lit(ld[ni].var, s);
+	}
+	int mi = newLitNode(v, pos);
 
 	Lit p = Lit(ld[ld[mi].next].var, 1);
 	Lit q = Lit(ld[ld[mi].prev].var, 0);
@@ -198,5 +227,6 @@ Lit IntVarLL::createLit(int _v) {
 		sat.aEnqueue(Lit(ld[mi].var, 0), r, l);
 	}
 
+	sat.incVarUse(ld[mi].var);
 	return Lit(ld[mi].var, s);
 }
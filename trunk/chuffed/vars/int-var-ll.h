@@ -3,11 +3,16 @@
 
 class IntVarLL : public IntVar {
 	static const bool ll_dec = true;
+	static const int ll_walk = 4;            // Nodes looked at from a bound before bisecting
 
 	struct LitNode { int var, val, prev, next; };
 
 	vec<LitNode> ld;
 	vec<int> freelist;
+	vec<int> order;                           // Nodes of ld in list order, i.e. sorted by val
+
+	int findPos(int v) const;
+	int newLitNode(int v, int pos);
 
 	Tint li, hi;
 
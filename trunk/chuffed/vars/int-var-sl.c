@@ -35,6 +35,11 @@ IntVarSL::IntVarSL(const IntVar& other, vec<int>& _values)
 
 	// create the IntVarEL
 	IntVar *v = newIntVar(0, values.size()-1);
+#ifdef LOGGING
+	// The root bounds of el hold for the same reasons as those of this var
+	v->lb0_reason = lb0_reason;
+	v->ub0_reason = ub0_reason;
+#endif
 	v->specialiseToEL();
 	el = (IntVarEL*) v;
 
@@ -47,17 +52,25 @@ IntVarSL::IntVarSL(const IntVar& other, vec<int>& _values)
 		Lit p = el->getLit(i, 2);
 		sat.c_info[var(p)].cons_id = var_id;
 	}
+#ifdef LOGGING
+	// The lits now describe this var rather than el, including [el >= size]
+	// which getLit folds to a constant
+	int blit0 = var(el->getLit(0, 2));
+	sat.c_info[blit0 + values.size()].cons_id = var_id;
+	logging::new_vars(var(el->getLit(0, 1)), values.size());
+	logging::new_vars(blit0, values.size()+1);
+#endif
 
 	// transfer pinfo to el
-	for (int i = 0; i < pinfo.size(); i++) {
-		el->pinfo.push(pinfo[i]);
+	for (int e = 0; e < num_buckets; e++) {
+		for (int i = 0; i < pinfo[e].size(); i++) el->pinfo[e].push(pinfo[e][i]);
+		pinfo[e].clear(true);
 	}
-	pinfo.clear(true);
 }
 
 void IntVarSL::attach(Propagator *p, int pos, int eflags) {
 	if (isFixed()) p->wakeup(pos, eflags);
-	else el->pinfo.push(PropInfo(p, pos, eflags));
+	else el->pushPInfo(PropInfo(p, pos, eflags));
 }
 
 int IntVarSL::transform(int v, int type) {
@@ -35,6 +35,15 @@ public:
 
 	void channel(int val, int val_type, int sign);
 	void debug();
+
+#ifdef LOGGING
+	// The value of x which a literal of el (with channel info val and
+	// val_type) refers to, for the proof log: [x = v] or [x > v].
+	int logValue(int val, int val_type) const {
+		if (val_type == 0 || val >= 0) return values[val];
+		return values[0]-1;
+	}
+#endif
 };
 
 
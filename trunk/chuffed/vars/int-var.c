@@ -27,7 +27,10 @@ IntVar::IntVar(int _min, int _max) :
 #endif
 	, vals(NULL)
 	, preferred_val(PV_MIN)
+	, sol_val(min_limit-1)
 	, activity(0)
+	, lr_score(0)
+	, last_conflict(-1)
 	, in_queue(false)
 {
 	assert(min_limit <= min && min <= max && max <= max_limit);
@@ -125,27 +128,46 @@ void IntVar::initVals(bool optional) {
 
 void IntVar::attach(Propagator *p, int pos, int eflags) {
 	if (isFixed()) p->wakeup(pos, eflags);
-	else pinfo.push(PropInfo(p, pos, eflags));
+	else pushPInfo(PropInfo(p, pos, eflags));
 }
 
 void IntVar::wakePropagators() {
-	for (int i = pinfo.size(); i--; ) {
-		PropInfo& pi = pinfo[i];
-		if ((pi.eflags & changes) == 0) continue;
-		if (pi.p->satisfied) continue;
-		if (pi.p == engine.last_prop) continue;
-		pi.p->wakeup(pi.pos, changes);
+	int ev = changes >> 1;
+	for (int e = 0; e < num_buckets; e++) {
+		if (e ? !(e & ev) : !(changes & EVENT_C)) continue;
+		vec<PropInfo>& ps = pinfo[e];
+		for (int i = ps.size(); i--; ) {
+			PropInfo& pi = ps[i];
+			if (pi.p->satisfied) {
+				PropInfo t = pi; pi = ps.last(); ps.last() = t;
+				trailChange(ps._size(), ps.size()-1);
+				continue;
+			}
+			if (pi.p == engine.last_prop) continue;
+			pi.p->wakeup(pi.pos, changes);
+		}
 	}
 	clearPropState();
 }
 
 int IntVar::simplifyWatches() {
-	int i, j;
-	for (i = j = 0; i < pinfo.size(); i++) {
-		if (!pinfo[i].p->satisfied) pinfo[j++] = pinfo[i];
+	int n = 0;
+	for (int e = 0; e < num_buckets; e++) {
+		vec<PropInfo>& ps = pinfo[e];
+		int i, j;
+		for (i = j = 0; i < ps.size(); i++) {
+			if (!ps[i].p->satisfied) ps[j++] = ps[i];
+		}
+		ps.resize(j);
+		n += j;
 	}
-	pinfo.resize(j);
-	return j;
+	return n;
+}
+
+int IntVar::degree() const {
+	int n = 0;
+	for (int e = 0; e < num_buckets; e++) n += pinfo[e].size();
+	return n;
 }
 
 //-----
@@ -166,10 +188,12 @@ double IntVar::getScore(VarBranch vb) {
 		case VAR_SIZE_MIN      : return min-max;
 		case VAR_SIZE_MAX      : return max-min;
 #endif
-		case VAR_DEGREE_MIN    : return -pinfo.size();
-		case VAR_DEGREE_MAX    : return pinfo.size();
+		case VAR_DEGREE_MIN    : return -degree();
+		case VAR_DEGREE_MAX    : return degree();
 		case VAR_REDUCED_COST  : return mip->getRC(this);
 		case VAR_ACTIVITY      : return activity;
+		case VAR_VMTF          : return last_conflict;
+		case VAR_LRB           : return lr_score;
                 case VAR_REGRET_MIN_MAX: return isFixed() ? 0 : (vals ? *++begin() - *begin() : 1);
 		default: NOT_SUPPORTED;
 	}
@@ -180,6 +204,7 @@ DecInfo* IntVar::branch() {
 //	for (int i = min; i <= max; i++) if (indomain(i)) possible.push(i);
 //	return new DecInfo(this, possible[rand()%possible.size()], 1);
 
+	if (so.sol_phase && indomain(sol_val)) return new DecInfo(this, sol_val, 1);
 
 	switch (preferred_val) {
 		case PV_MIN       : return new DecInfo(this, min, 1);
@@ -66,8 +66,11 @@ public:
 #endif
 
 	PreferredVal preferred_val;
+	int sol_val;                     // Value in the last solution, tried first with sol_phase
 
 	double activity;
+	double lr_score;                 // Moving average of 1/(conflicts between the ones it takes part in)
+	long long int last_conflict;     // Last conflict taken part in
 
 	IntVar(int min, int max);
 
@@ -102,9 +105,22 @@ public:
 	bool in_queue;
 
 	// persistent state
-	vec<PropInfo> pinfo;
+	// Watches bucketed by the events they want, so that a change only looks
+	// at the propagators it wakes.  pinfo[0] holds those woken by any change
+	// (EVENT_C), pinfo[e] those woken by the bound and fix events in e << 1.
+	// Satisfied propagators are dropped when met, by swapping them past the
+	// end and trailing the size.  A push below the root would overwrite the
+	// first hidden entry, which is lost on backtracking, so propagators are
+	// only attached at the root.
+	static const int num_buckets = 8;
+	vec<PropInfo> pinfo[num_buckets];
 
 	virtual void attach(Propagator *p, int pos, int eflags);
+	void pushPInfo(const PropInfo& pi) {
+		assert(engine.decisionLevel() == 0);
+		pinfo[pi.eflags & EVENT_C ? 0 : pi.eflags >> 1].push(pi);
+	}
+	int degree() const;
 
 	void pushInQueue();
 	void wakePropagators();